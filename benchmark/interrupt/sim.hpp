@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdx/compiler.hpp>
+#include <stdx/tuple.hpp>
+#include <stdx/tuple_algorithms.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * A host-side model of interrupt hardware, for running an interrupt::manager
+ * on a development machine.
+ *
+ * Registers are plain variables. Every read and write made by the interrupt
+ * code is counted, so the cost of a dispatch can be measured in register
+ * accesses as well as in time.
+ */
+namespace interrupt::sim {
+struct access_counts {
+    std::uint64_t reads{};
+    std::uint64_t writes{};
+};
+
+CONSTINIT inline access_counts counts{};
+
+inline auto reset_counts() -> void { counts = {}; }
+
+/**
+ * A 32-bit memory-mapped register.
+ *
+ * @tparam Id
+ *      Distinguishes registers from each other.
+ *
+ * @tparam WriteOneToClear
+ *      Whether writing a '1' to a bit clears it, as is usual for status
+ * registers. Otherwise a write stores the value written.
+ */
+template <int Id, bool WriteOneToClear> struct mmio_register;
+
+template <typename Reg, int Msb, int Lsb> struct field;
+
+template <typename Field> struct field_value {
+    typename Field::DataType value;
+};
+
+template <typename Reg, int Msb, int Lsb> struct field {
+    using RegisterType = Reg;
+    using DataType = std::uint32_t;
+
+    constexpr static auto get_register() -> Reg { return {}; }
+
+    constexpr static auto get_mask() -> DataType {
+        return static_cast<DataType>(~DataType{} >> (31 - (Msb - Lsb)))
+               << Lsb;
+    }
+
+    constexpr auto operator()(DataType value) const {
+        return field_value<field>{value};
+    }
+};
+
+template <int Id, bool WriteOneToClear> struct mmio_register {
+    using RegisterType = mmio_register;
+    using DataType = std::uint32_t;
+
+    constexpr static auto write_one_to_clear = WriteOneToClear;
+    constexpr static field<mmio_register, 31, 0> raw{};
+
+    constexpr static auto get_register() -> mmio_register { return {}; }
+
+    CONSTINIT static inline DataType value{};
+};
+
+template <int Id> using enable_register = mmio_register<Id, false>;
+template <int Id> using status_register = mmio_register<Id, true>;
+
+template <typename Field> struct read_op {
+    auto operator()() const -> typename Field::DataType {
+        using reg_t = typename Field::RegisterType;
+        ++counts.reads;
+        return (reg_t::value & Field::get_mask()) >>
+               std::countr_zero(Field::get_mask());
+    }
+};
+
+template <typename... Values> struct write_op {
+    stdx::tuple<Values...> values;
+
+    auto operator()() const -> void {
+        stdx::for_each([](auto v) { store(v); }, values);
+    }
+
+  private:
+    template <typename Field> static auto store(field_value<Field> v) -> void {
+        using reg_t = typename Field::RegisterType;
+        constexpr auto mask = Field::get_mask();
+        auto const bits = static_cast<typename Field::DataType>(
+                              v.value << std::countr_zero(mask)) &
+                          mask;
+
+        if constexpr (reg_t::write_one_to_clear) {
+            reg_t::value &= ~bits;
+        } else if constexpr (mask == ~typename Field::DataType{}) {
+            reg_t::value = bits;
+        } else {
+            // a field narrower than its register costs a read-modify-write
+            ++counts.reads;
+            reg_t::value = (reg_t::value & ~mask) | bits;
+        }
+        ++counts.writes;
+    }
+};
+
+template <typename Field> constexpr auto read(Field) { return read_op<Field>{}; }
+
+template <typename... Values> constexpr auto write(Values... values) {
+    return write_op<Values...>{stdx::make_tuple(values...)};
+}
+
+/**
+ * Clear fields: status fields are written with ones, other fields with zeros.
+ */
+template <typename... Fields> constexpr auto clear(Fields...) {
+    return write_op<field_value<Fields>...>{stdx::make_tuple(field_value<Fields>{
+        Fields::RegisterType::write_one_to_clear ? ~std::uint32_t{} : 0u}...)};
+}
+
+template <typename Field> auto apply(read_op<Field> op) { return op(); }
+
+template <typename... Ops> auto apply(Ops... ops) -> void { (ops(), ...); }
+
+/**
+ * Set status bits from the hardware side. This is not counted as an access.
+ */
+template <typename Reg> auto raise(typename Reg::DataType bits) -> void {
+    Reg::value |= bits;
+}
+
+/**
+ * An InterruptHal for the simulation. There is no interrupt controller: an
+ * interrupt is taken by calling the manager's run<IrqNumber>() directly.
+ */
+struct interrupt_hal {
+    static auto init() -> void {}
+
+    template <bool Enable, std::size_t IrqNumber, std::size_t Priority>
+    static auto irqInit() -> void {
+        enabled<IrqNumber> = Enable;
+    }
+
+    template <typename StatusPolicy, typename Callable>
+    static auto run(std::size_t, Callable const &interrupt_service_routine)
+        -> void {
+        StatusPolicy::run([] {}, interrupt_service_routine);
+    }
+
+    template <std::size_t IrqNumber> CONSTINIT static inline bool enabled{};
+};
+} // namespace interrupt::sim
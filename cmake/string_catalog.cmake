@@ -1,27 +1,45 @@
 function(gen_str_catalog)
-    set(options "")
+    set(options HASH_IDS)
     set(oneValueArgs OUTPUT_CPP OUTPUT_XML OUTPUT_JSON GEN_STR_CATALOG
-                     OUTPUT_LIB)
+                     OUTPUT_LIB KNOWN_IDS)
     set(multiValueArgs INPUT_LIBS)
     cmake_parse_arguments(SC "${options}" "${oneValueArgs}" "${multiValueArgs}"
                           ${ARGN})
 
+    # each library's catalog symbols are extracted by a separate command, so
+    # that they run in parallel; a symbols file only changes when its
+    # library's set of catalog symbols does
+    get_filename_component(SC_TOOLS_DIR ${SC_GEN_STR_CATALOG} DIRECTORY)
+    set(SYMBOL_FILES "")
     foreach(X IN LISTS SC_INPUT_LIBS)
+        set(SYMBOL_FILE ${CMAKE_CURRENT_BINARY_DIR}/${X}.catalog_symbols.txt)
         add_custom_command(
-            OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/undefined_symbols.txt
-            DEPENDS ${X}
-            COMMAND ${CMAKE_NM} -uC "lib${X}.a" >
-                    ${CMAKE_CURRENT_BINARY_DIR}/undefined_symbols.txt)
+            OUTPUT ${SYMBOL_FILE}
+            DEPENDS ${X} ${SC_TOOLS_DIR}/catalog_symbols.py
+            COMMAND
+                ${Python3_EXECUTABLE} ${SC_TOOLS_DIR}/catalog_symbols.py
+                ${CMAKE_NM} $<TARGET_FILE:${X}> ${SYMBOL_FILE})
+        list(APPEND SYMBOL_FILES ${SYMBOL_FILE})
     endforeach()
 
+    # KNOWN_IDS names the JSON output of a previous build (e.g. checked in):
+    # its strings and modules keep their IDs
+    set(ID_ARGS "")
+    set(ID_DEPENDS "")
+    if(SC_KNOWN_IDS)
+        list(APPEND ID_ARGS --known_ids ${SC_KNOWN_IDS})
+        list(APPEND ID_DEPENDS ${SC_KNOWN_IDS})
+    endif()
+    if(SC_HASH_IDS)
+        list(APPEND ID_ARGS --hash_ids)
+    endif()
+
     add_custom_command(
         OUTPUT ${SC_OUTPUT_CPP} ${SC_OUTPUT_JSON} ${SC_OUTPUT_XML}
         COMMAND
-            ${Python3_EXECUTABLE} ${SC_GEN_STR_CATALOG}
-            ${CMAKE_CURRENT_BINARY_DIR}/undefined_symbols.txt ${SC_OUTPUT_CPP}
-            ${SC_OUTPUT_JSON} ${SC_OUTPUT_XML}
-        DEPENDS ${CMAKE_CURRENT_BINARY_DIR}/undefined_symbols.txt
-                ${SC_GEN_STR_CATALOG})
+            ${Python3_EXECUTABLE} ${SC_GEN_STR_CATALOG} ${SYMBOL_FILES}
+            ${SC_OUTPUT_CPP} ${SC_OUTPUT_JSON} ${SC_OUTPUT_XML} ${ID_ARGS}
+        DEPENDS ${SYMBOL_FILES} ${SC_GEN_STR_CATALOG} ${ID_DEPENDS})
 
     add_library(${SC_OUTPUT_LIB} STATIC ${SC_OUTPUT_CPP})
     target_link_libraries(${SC_OUTPUT_LIB} PUBLIC cib)
@@ -28,6 +28,59 @@ struct builder : graph_builder<node, Name, NodeCapacity, EdgeCapacity,
                                builder<Name, NodeCapacity, EdgeCapacity>> {
     template <typename N, std::size_t Capacity>
     using impl_t = flow::impl<N, Capacity>;
+
+  private:
+    template <typename BuilderValue> static auto run_impl() -> void {
+        constexpr auto built = make_impl<BuilderValue>();
+        static_assert(built.has_value());
+        built.value()();
+    }
+
+  public:
+    template <typename BuilderValue>
+    [[nodiscard]] constexpr static auto build() -> FunctionPtr {
+        return run_impl<BuilderValue>;
+    }
+};
+
+/**
+ * A flow::builder whose built service can be executed in slices.
+ *
+ * Instead of running the whole flow, the built service runs nodes until the
+ * given budget is exhausted and remembers where it stopped. The next call
+ * continues from there. This bounds the time spent in a long flow such as
+ * MainLoop, at the cost of spreading one pass over several calls.
+ *
+ * @see flow::impl::resume
+ */
+template <typename Name = void, std::size_t NodeCapacity = 64,
+          std::size_t EdgeCapacity = 16>
+struct resumable_builder
+    : graph_builder<node, Name, NodeCapacity, EdgeCapacity,
+                    resumable_builder<Name, NodeCapacity, EdgeCapacity>> {
+    template <typename N, std::size_t Capacity>
+    using impl_t = flow::impl<N, Capacity>;
+
+  private:
+    template <typename BuilderValue>
+    static auto resume_impl(budget_ref budget) -> bool {
+        constexpr auto built = make_impl<BuilderValue>();
+        static_assert(built.has_value());
+
+        static std::size_t cursor{};
+        cursor = built->resume(cursor, budget);
+        if (cursor == built->size()) {
+            cursor = 0;
+            return true;
+        }
+        return false;
+    }
+
+  public:
+    template <typename BuilderValue>
+    [[nodiscard]] constexpr static auto build() -> ResumableFunctionPtr {
+        return resume_impl<BuilderValue>;
+    }
 };
 
 /**
@@ -43,4 +96,18 @@ template <typename Name = void, std::size_t NodeCapacity = 64,
           std::size_t EdgeCapacity = 16>
 struct service : cib::builder_meta<builder<Name, NodeCapacity, EdgeCapacity>,
                                    FunctionPtr> {};
+
+/**
+ * Extend this to create named resumable flow services.
+ *
+ * The service is a function taking a budget and returning true when a complete
+ * pass of the flow has finished.
+ *
+ * @see flow::resumable_builder
+ */
+template <typename Name = void, std::size_t NodeCapacity = 64,
+          std::size_t EdgeCapacity = 16>
+struct resumable_service
+    : cib::builder_meta<resumable_builder<Name, NodeCapacity, EdgeCapacity>,
+                        ResumableFunctionPtr> {};
 } // namespace flow
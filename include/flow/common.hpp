@@ -1,5 +1,50 @@
 #pragma once
 
+#include <concepts>
+#include <memory>
+#include <type_traits>
+
 namespace flow {
 using FunctionPtr = auto (*)() -> void;
+
+/**
+ * A non-owning reference to a budget: any callable that returns true while
+ * there is budget to execute another node.
+ *
+ * Unlike a function pointer, the budget can carry state, such as a deadline
+ * or a count of nodes. The referenced callable must outlive the call it is
+ * passed to.
+ */
+class budget_ref {
+    union target {
+        void *object;
+        auto (*function)() -> bool;
+    };
+
+    target budget;
+    auto (*check)(target) -> bool;
+
+  public:
+    template <typename Budget>
+        requires(std::is_object_v<std::remove_reference_t<Budget>> and
+                 not std::same_as<std::remove_cvref_t<Budget>, budget_ref> and
+                 std::predicate<Budget &>)
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    constexpr budget_ref(Budget &&b)
+        : budget{.object = const_cast<void *>(
+                     static_cast<void const *>(std::addressof(b)))},
+          check{[](target t) -> bool {
+              return (*static_cast<std::remove_reference_t<Budget> *>(
+                  t.object))();
+          }} {}
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    constexpr budget_ref(auto (*f)() -> bool)
+        : budget{.function = f},
+          check{[](target t) -> bool { return t.function(); }} {}
+
+    auto operator()() const -> bool { return check(budget); }
+};
+
+using ResumableFunctionPtr = auto (*)(budget_ref) -> bool;
 } // namespace flow
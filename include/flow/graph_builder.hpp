@@ -9,10 +9,20 @@
 #include <array>
 #include <concepts>
 #include <cstddef>
+#include <iterator>
 #include <optional>
 #include <span>
 
 namespace flow {
+/**
+ * A dependency between two nodes of a built graph, given as indices into the
+ * topologically sorted node order.
+ */
+struct edge {
+    std::size_t from{};
+    std::size_t to{};
+};
+
 namespace detail {
 template <typename T, typename Node>
 concept walkable = std::same_as<T, Node> or
@@ -62,6 +72,25 @@ class graph_builder {
         return s;
     }
 
+    template <typename OrderedList>
+    [[nodiscard]] constexpr auto get_edges(OrderedList const &ordered_list) const
+        -> stdx::cx_vector<edge, NodeCapacity * EdgeCapacity> {
+        auto const index_of = [&](Node const &n) -> std::size_t {
+            return static_cast<std::size_t>(std::distance(
+                std::cbegin(ordered_list),
+                std::find(std::cbegin(ordered_list), std::cend(ordered_list),
+                          n)));
+        };
+
+        stdx::cx_vector<edge, NodeCapacity * EdgeCapacity> edges{};
+        for (auto const &entry : graph) {
+            for (auto const &dst : entry.value) {
+                edges.push_back({index_of(entry.key), index_of(dst)});
+            }
+        }
+        return edges;
+    }
+
     constexpr auto insert(Node const &node) -> void { graph.put(node); }
 
     template <detail::walkable<Node> T>
@@ -124,7 +153,9 @@ class graph_builder {
      * Create an object combining all the specifications previously given to the
      * builder.
      *
-     * @tparam Output The (template) type of the output object.
+     * @tparam Output The (template) type of the output object. It is
+     * constructed from the ordered nodes and, if it accepts them, the edges
+     * between those nodes.
      * @tparam Capacity The maximum number of nodes the object will contain.
      * This can be optimized to the minimal value if the builder is assigned to
      * a constexpr variable. The size() method can then be used as this template
@@ -162,9 +193,19 @@ class graph_builder {
         if (not g.empty()) {
             return {};
         }
-        return std::optional<Output<Name, Capacity>>{
-            std::in_place,
-            std::span{std::cbegin(ordered_list), std::size(ordered_list)}};
+
+        using output_t = Output<Name, Capacity>;
+        auto const nodes =
+            std::span{std::cbegin(ordered_list), std::size(ordered_list)};
+        if constexpr (std::constructible_from<output_t, decltype(nodes),
+                                              std::span<edge const>>) {
+            auto const edges = get_edges(ordered_list);
+            return std::optional<output_t>{
+                std::in_place, nodes,
+                std::span{std::cbegin(edges), std::size(edges)}};
+        } else {
+            return std::optional<output_t>{std::in_place, nodes};
+        }
     }
 
     /**
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cib/detail/nexus_details.hpp>
+#include <flow/graph_builder.hpp>
+
+#include <stdx/ct_conversions.hpp>
+#include <stdx/tuple_algorithms.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace flow {
+/**
+ * The resolved form of a flow or seq graph: node names in execution order,
+ * and the dependencies between them as indices into that order.
+ *
+ * This is a host-side output type for graph_builder::topo_sort, used to export
+ * graphs for inspection. It is not intended to be used on target.
+ */
+template <typename, std::size_t> struct graph_description {
+    std::vector<std::string_view> nodes{};
+    std::vector<edge> edges{};
+
+    template <typename Node>
+    graph_description(std::span<Node const> ns, std::span<edge const> es)
+        : edges(std::cbegin(es), std::cend(es)) {
+        std::transform(std::cbegin(ns), std::cend(ns),
+                       std::back_inserter(nodes),
+                       [](auto const &n) { return n.name; });
+    }
+};
+
+namespace detail {
+template <typename T>
+concept exportable_graph = requires(T const &t) {
+    t.template topo_sort<graph_description, 0>();
+};
+
+template <typename OutputIt>
+auto write_escaped(OutputIt out, std::string_view s) -> OutputIt {
+    for (auto c : s) {
+        if (c == '"' or c == '\\') {
+            *out++ = '\\';
+        }
+        *out++ = c;
+    }
+    return out;
+}
+
+template <typename Config, typename F> auto for_each_graph(F &&f) -> void {
+    stdx::for_each(
+        [&]<typename Entry>(Entry const &entry) {
+            if constexpr (exportable_graph<decltype(entry.builder)>) {
+                auto const g =
+                    entry.builder
+                        .template topo_sort<graph_description, 0>();
+                if (g.has_value()) {
+                    f(stdx::type_as_string<typename Entry::Service>(), *g);
+                }
+            }
+        },
+        cib::initialized_builders<Config>);
+}
+} // namespace detail
+
+/**
+ * Write every flow and seq service in a nexus configuration as a Graphviz DOT
+ * digraph, one cluster per service.
+ *
+ * Nodes are labelled with their name and numbered by their position in the
+ * execution order, so a named flow traces them in ascending number when it
+ * runs.
+ *
+ * @tparam Config The project configuration, as given to cib::nexus.
+ */
+template <typename Config, typename OutputIt>
+auto export_dot(OutputIt out) -> OutputIt {
+    out = ::fmt::format_to(out, "digraph cib {{\n");
+    auto graph_index = std::size_t{};
+    detail::for_each_graph<Config>([&](std::string_view name, auto const &g) {
+        out = ::fmt::format_to(out, "  subgraph cluster_{} {{\n    label=\"",
+                               graph_index);
+        out = detail::write_escaped(out, name);
+        out = ::fmt::format_to(out, "\";\n");
+        for (auto i = std::size_t{}; i < std::size(g.nodes); ++i) {
+            out = ::fmt::format_to(out, "    g{}_{} [label=\"{}: ", graph_index,
+                                   i, i);
+            out = detail::write_escaped(out, g.nodes[i]);
+            out = ::fmt::format_to(out, "\"];\n");
+        }
+        for (auto const &e : g.edges) {
+            out = ::fmt::format_to(out, "    g{}_{} -> g{}_{};\n", graph_index,
+                                   e.from, graph_index, e.to);
+        }
+        out = ::fmt::format_to(out, "  }}\n");
+        ++graph_index;
+    });
+    return ::fmt::format_to(out, "}}\n");
+}
+
+/**
+ * Write every flow and seq service in a nexus configuration as JSON.
+ *
+ * Each service is an object with its name, the node names in execution order
+ * ("order"), and the dependencies between nodes as pairs of indices into that
+ * order ("edges"). tools/flow_profile.py can merge runtime timing data into
+ * this output.
+ *
+ * @tparam Config The project configuration, as given to cib::nexus.
+ */
+template <typename Config, typename OutputIt>
+auto export_json(OutputIt out) -> OutputIt {
+    out = ::fmt::format_to(out, "{{\"graphs\": [");
+    auto first_graph = true;
+    detail::for_each_graph<Config>([&](std::string_view name, auto const &g) {
+        out = ::fmt::format_to(out, "{}\n  {{\"name\": \"",
+                               first_graph ? "" : ",");
+        first_graph = false;
+        out = detail::write_escaped(out, name);
+        out = ::fmt::format_to(out, "\",\n   \"order\": [");
+        for (auto i = std::size_t{}; i < std::size(g.nodes); ++i) {
+            out = ::fmt::format_to(out, "{}\"", i == 0 ? "" : ", ");
+            out = detail::write_escaped(out, g.nodes[i]);
+            out = ::fmt::format_to(out, "\"");
+        }
+        out = ::fmt::format_to(out, "],\n   \"edges\": [");
+        for (auto i = std::size_t{}; i < std::size(g.edges); ++i) {
+            out = ::fmt::format_to(out, "{}[{}, {}]", i == 0 ? "" : ", ",
+                                   g.edges[i].from, g.edges[i].to);
+        }
+        out = ::fmt::format_to(out, "]}}");
+    });
+    return ::fmt::format_to(out, "\n]}}\n");
+}
+} // namespace flow
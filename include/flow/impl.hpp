@@ -3,14 +3,20 @@
 #include <flow/common.hpp>
 #include <flow/milestone.hpp>
 #include <log/log.hpp>
+#include <sc/string_constant.hpp>
 
 #include <stdx/cx_vector.hpp>
 
 #include <algorithm>
+#include <array>
+#include <concepts>
 #include <cstddef>
 #include <iterator>
+#include <optional>
 #include <span>
+#include <string_view>
 #include <type_traits>
+#include <utility>
 
 namespace flow {
 // NOLINTNEXTLINE(cppcoreguidelines-virtual-class-destructor)
@@ -39,18 +45,22 @@ template <typename Name, std::size_t NumSteps> class impl : public interface {
   private:
     constexpr static bool loggingEnabled = not std::is_void_v<Name>;
 
-    constexpr static auto capacity = [] {
+    using node_logger_t = auto (*)(std::size_t) -> void;
+
+    stdx::cx_vector<FunctionPtr, NumSteps> functionPtrs{};
+    node_logger_t log_node{};
+
+    auto run_node(std::size_t index) const -> void {
         if constexpr (loggingEnabled) {
-            return NumSteps * 2;
-        } else {
-            return NumSteps;
+            if (log_node != nullptr) {
+                log_node(index);
+            }
         }
-    }();
-
-    stdx::cx_vector<FunctionPtr, capacity> functionPtrs{};
+        functionPtrs[index]();
+    }
 
   public:
-    constexpr static bool active = capacity > 0;
+    constexpr static bool active = NumSteps > 0;
 
     /**
      * Create a new flow::impl of Milestones.
@@ -64,16 +74,9 @@ template <typename Name, std::size_t NumSteps> class impl : public interface {
      */
     constexpr explicit(true) impl(std::span<node const> newMilestones) {
         CIB_ASSERT(NumSteps >= std::size(newMilestones));
-        if constexpr (loggingEnabled) {
-            for (auto const &milestone : newMilestones) {
-                functionPtrs.push_back(milestone.log_name);
-                functionPtrs.push_back(milestone.run);
-            }
-        } else {
-            std::transform(std::cbegin(newMilestones), std::cend(newMilestones),
-                           std::back_inserter(functionPtrs),
-                           [](auto const &milestone) { return milestone.run; });
-        }
+        std::transform(std::cbegin(newMilestones), std::cend(newMilestones),
+                       std::back_inserter(functionPtrs),
+                       [](auto const &milestone) { return milestone.run; });
     }
 
     /**
@@ -84,13 +87,141 @@ template <typename Name, std::size_t NumSteps> class impl : public interface {
             CIB_TRACE("flow.start({})", Name{});
         }
 
-        for (auto const func : functionPtrs) {
-            func();
+        for (auto i = std::size_t{}; i < std::size(functionPtrs); ++i) {
+            run_node(i);
         }
 
         if constexpr (loggingEnabled) {
             CIB_TRACE("flow.end({})", Name{});
         }
     }
+
+    /**
+     * Set the function that traces each node before it runs, given the
+     * node's index in the flow order. flow::make_impl sets one that traces
+     * the node's name.
+     */
+    constexpr auto trace_nodes(node_logger_t logger) -> void {
+        log_node = logger;
+    }
+
+    /**
+     * @return The number of nodes in the flow.
+     */
+    [[nodiscard]] constexpr auto size() const -> std::size_t {
+        return std::size(functionPtrs);
+    }
+
+    /**
+     * Execute the flow from a given node, for as long as the budget allows.
+     *
+     * The budget is checked after each node is executed, so it can count
+     * nodes or compare a timer against a deadline. At least one node is
+     * always executed per call, so a flow is guaranteed to make progress.
+     *
+     * @param cursor
+     *      Index of the next node to execute. Zero starts a new pass.
+     *
+     * @param budget
+     *      Returns true while there is budget to execute another node.
+     *
+     * @return The cursor to resume from. A value of size() means the flow has
+     * run to completion.
+     */
+    template <std::predicate Budget>
+    auto resume(std::size_t cursor, Budget &&budget) const -> std::size_t {
+        CIB_ASSERT(cursor <= size());
+        if constexpr (loggingEnabled) {
+            if (cursor == 0) {
+                CIB_TRACE("flow.start({})", Name{});
+            }
+        }
+
+        auto i = cursor;
+        while (i != std::size(functionPtrs)) {
+            run_node(i++);
+            if (not budget()) {
+                break;
+            }
+        }
+
+        if constexpr (loggingEnabled) {
+            if (i == std::size(functionPtrs)) {
+                CIB_TRACE("flow.end({})", Name{});
+            }
+        }
+        return i;
+    }
+};
+
+namespace detail {
+// the names of a flow's nodes in the flow order, which is only ever built at
+// compile time: the names become string constants rather than runtime data
+template <typename Name, std::size_t NumSteps> struct node_names {
+    stdx::cx_vector<std::string_view, NumSteps> names{};
+
+    constexpr explicit(true) node_names(std::span<node const> nodes) {
+        for (auto const &n : nodes) {
+            names.push_back(n.name);
+        }
+    }
+};
+
+template <typename BuilderValue> struct ordered_node_names {
+    constexpr static auto value =
+        BuilderValue::value
+            .template topo_sort<node_names, BuilderValue::value.size()>();
 };
+
+template <typename Names, std::size_t I> constexpr auto node_name() {
+    constexpr auto s = Names::value->names[I];
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        return sc::string_constant<char, s[Is]...>{};
+    }(std::make_index_sequence<std::size(s)>{});
+}
+
+template <typename Name, typename Names, std::size_t I>
+auto trace_node() -> void {
+    CIB_TRACE("flow.node({}, {})", Name{}, node_name<Names, I>());
+}
+
+// one trace function per node, in the flow order
+template <typename Name, typename Names>
+constexpr auto node_tracers =
+    []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return std::array<FunctionPtr, sizeof...(Is)>{
+            &trace_node<Name, Names, Is>...};
+    }(std::make_index_sequence<std::size(Names::value->names)>{});
+
+/**
+ * Trace the node at a given index of a flow. There is one of these per flow;
+ * each node has its own trace statement, so that its record carries a string
+ * ID for the flow and node names rather than an index to be looked up.
+ */
+template <typename Name, typename Names>
+auto log_node(std::size_t index) -> void {
+    node_tracers<Name, Names>[index]();
+}
+} // namespace detail
+
+/**
+ * Build a flow::impl from a builder given as a type with a static constexpr
+ * value, in the same way as cib builds services. If the flow is named, its
+ * nodes are traced by name.
+ *
+ * @return The flow::impl, or no value if the flow has a cycle.
+ */
+template <typename BuilderValue> constexpr auto make_impl() {
+    constexpr auto builder = BuilderValue::value;
+    using name_t = typename decltype(builder)::Name;
+    auto built = builder.template topo_sort<impl, builder.size()>();
+    if constexpr (not std::is_void_v<name_t>) {
+        if (built.has_value()) {
+            built->trace_nodes(
+                detail::log_node<name_t,
+                                 detail::ordered_node_names<BuilderValue>>);
+        }
+    }
+    return built;
+}
 } // namespace flow
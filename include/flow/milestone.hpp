@@ -1,14 +1,15 @@
 #pragma once
 
 #include <flow/common.hpp>
-#include <log/log.hpp>
+
+#include <string_view>
 
 namespace flow {
 struct node {
     using is_node = void;
 
     FunctionPtr run{[] {}};
-    FunctionPtr log_name{[] {}};
+    std::string_view name{};
 
   private:
     [[nodiscard]] friend constexpr auto operator==(node const &lhs,
@@ -25,7 +26,7 @@ struct node {
  */
 template <typename Name>
 [[nodiscard]] constexpr auto action(Name, FunctionPtr f) -> node {
-    return {.run = f, .log_name = [] { CIB_TRACE("flow.action({})", Name{}); }};
+    return {.run = f, .name = Name::value};
 }
 
 /**
@@ -33,6 +34,6 @@ template <typename Name>
  *      Node with no associated action.
  */
 template <typename Name> [[nodiscard]] constexpr auto milestone(Name) -> node {
-    return {.log_name = [] { CIB_TRACE("flow.milestone({})", Name{}); }};
+    return {.name = Name::value};
 }
 } // namespace flow
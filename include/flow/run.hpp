@@ -11,4 +11,15 @@ namespace flow {
  * used to declare and build the flow.
  */
 template <typename Tag> FunctionPtr &run = cib::service<Tag>;
+
+/**
+ * Resume the resumable flow given by 'Tag'.
+ *
+ * Calling this with a budget runs the flow until the budget is exhausted and
+ * returns true when a complete pass of the flow has finished.
+ *
+ * @tparam Tag Type of the flow to be resumed. This is the name of the
+ * flow::resumable_builder used to declare and build the flow.
+ */
+template <typename Tag> ResumableFunctionPtr &resume = cib::service<Tag>;
 } // namespace flow
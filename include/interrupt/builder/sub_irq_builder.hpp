@@ -19,6 +19,11 @@ template <typename ConfigT> struct sub_irq_builder {
   private:
     IrqCallbackType interrupt_service_routine;
 
+    template <typename BuilderValue> struct isr_builder_value {
+        constexpr static auto value =
+            BuilderValue::value.interrupt_service_routine;
+    };
+
   public:
     /**
      * Add interrupt service routine(s) to be executed when this IRQ is
@@ -42,11 +47,8 @@ template <typename ConfigT> struct sub_irq_builder {
     template <typename BuilderValue>
     [[nodiscard]] constexpr auto build() const {
         constexpr auto run_flow = [] {
-            auto constexpr flow_builder =
-                BuilderValue::value.interrupt_service_routine;
-            auto constexpr flow_size = flow_builder.size();
             auto constexpr flow =
-                flow_builder.template topo_sort<flow::impl, flow_size>();
+                flow::make_impl<isr_builder_value<BuilderValue>>();
             flow.value()();
         };
 
@@ -29,6 +29,11 @@ struct irq {
         InterruptHal::template irqInit<en, IrqNumberT, IrqPriorityT>;
     using StatusPolicy = typename PoliciesT::template type<status_clear_policy,
                                                            clear_status_first>;
+    static_assert(not detail::is_clear_status_batched<StatusPolicy>,
+                  "clear_status_batched only applies to sub_irqs: an irq "
+                  "using it would never clear its status");
+    using ExecutionPolicy =
+        typename PoliciesT::template type<execution_policy, run_immediately>;
     constexpr static auto resources =
         PoliciesT::template get<required_resources_policy,
                                 required_resources<>>()
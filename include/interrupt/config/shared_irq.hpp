@@ -35,6 +35,9 @@ struct shared_irq {
         InterruptHal::template irqInit<en, IrqNumberT, IrqPriorityT>;
     using StatusPolicy = typename PoliciesT::template type<status_clear_policy,
                                                            clear_status_first>;
+    static_assert(not detail::is_clear_status_batched<StatusPolicy>,
+                  "clear_status_batched only applies to sub_irqs: a shared_irq "
+                  "using it would never clear its status");
     constexpr static auto resources =
         PoliciesT::template get<required_resources_policy,
                                 required_resources<>>()
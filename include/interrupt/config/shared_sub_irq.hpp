@@ -15,6 +15,9 @@ struct shared_sub_irq {
     constexpr static auto status_field = StatusField{};
     using StatusPolicy = typename PoliciesT::template type<status_clear_policy,
                                                            clear_status_first>;
+    constexpr static auto priority =
+        PoliciesT::template type<dispatch_priority_policy,
+                                 dispatch_priority<>>::value;
     constexpr static auto resources =
         PoliciesT::template get<required_resources_policy,
                                 required_resources<>>()
@@ -29,6 +29,11 @@ struct sub_irq {
     constexpr static auto status_field = StatusField{};
     using StatusPolicy = typename PoliciesT::template type<status_clear_policy,
                                                            clear_status_first>;
+    using ExecutionPolicy =
+        typename PoliciesT::template type<execution_policy, run_immediately>;
+    constexpr static auto priority =
+        PoliciesT::template type<dispatch_priority_policy,
+                                 dispatch_priority<>>::value;
     constexpr static auto resources =
         PoliciesT::template get<required_resources_policy,
                                 required_resources<>>()
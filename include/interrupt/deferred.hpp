@@ -0,0 +1,126 @@
+#pragma once
+
+#include <interrupt/fwd.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace interrupt {
+/**
+ * A lock-free multi-producer, single-consumer ring of deferred interrupt
+ * service routines.
+ *
+ * Interrupts push routines and the main loop (or a worker) runs them later,
+ * outside of interrupt context. Producers reserve a slot with a
+ * compare-and-swap and then commit the routine to it, so irqs at different
+ * priorities may preempt each other mid-push. The consumer runs committed
+ * routines in the order their slots were reserved and stops at the first one
+ * still being written.
+ *
+ * @tparam Capacity
+ *      The maximum number of routines waiting to run. Must be a power of two.
+ */
+template <std::size_t Capacity> class deferred_queue {
+    static_assert(std::has_single_bit(Capacity),
+                  "deferred_queue capacity must be a power of two");
+
+    // a null slot has been reserved (or not yet reached) but not committed
+    std::array<FunctionPtr, Capacity> routines{};
+    std::atomic<std::size_t> head{};
+    std::atomic<std::size_t> tail{};
+    std::atomic<std::uint32_t> dropped{};
+
+    auto slot(std::size_t index) -> std::atomic_ref<FunctionPtr> {
+        return std::atomic_ref{routines[index % Capacity]};
+    }
+
+  public:
+    /**
+     * Queue a routine. Called from interrupt context.
+     *
+     * @return false if the queue was full and the routine was dropped.
+     */
+    auto push(FunctionPtr routine) -> bool {
+        auto t = tail.load(std::memory_order_relaxed);
+        do {
+            if (t - head.load(std::memory_order_acquire) == Capacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (not tail.compare_exchange_weak(t, t + 1,
+                                                std::memory_order_relaxed));
+        slot(t).store(routine, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Run the routines queued so far, in the order they were queued. Must not
+     * be called concurrently with itself.
+     *
+     * Routines queued while this is running are left for the next call, so
+     * an interrupt storm cannot keep the caller here indefinitely.
+     *
+     * @return The number of routines run.
+     */
+    auto run() -> std::size_t {
+        auto h = head.load(std::memory_order_relaxed);
+        auto const t = tail.load(std::memory_order_acquire);
+        auto n = std::size_t{};
+        for (; h != t; ++h, ++n) {
+            auto const routine = slot(h).load(std::memory_order_acquire);
+            if (routine == nullptr) {
+                break; // reserved, but still being written
+            }
+            // a stale routine would look like a committed one later
+            slot(h).store(nullptr, std::memory_order_relaxed);
+            head.store(h + 1, std::memory_order_release);
+            routine();
+        }
+        return n;
+    }
+
+    [[nodiscard]] auto size() const -> std::size_t {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @return The number of routines dropped because the queue was full.
+     */
+    [[nodiscard]] auto dropped_count() const -> std::uint32_t {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * The queue used by irqs and sub_irqs with the deferred policy. To change its
+ * capacity, specialize this variable:
+ *
+ *     template <>
+ *     inline auto interrupt::deferred_work<> = interrupt::deferred_queue<64>{};
+ */
+template <typename...> inline auto deferred_work = deferred_queue<16>{};
+
+/**
+ * Queue an interrupt service routine to be run by run_deferred().
+ */
+template <typename... Ts> auto defer(FunctionPtr routine) -> bool {
+    auto &q = deferred_work<Ts...>;
+    return q.push(routine);
+}
+
+/**
+ * Run the deferred interrupt service routines that have been queued so far.
+ * This should be called from the main loop or a worker, outside of interrupt
+ * context.
+ *
+ * @return The number of routines run.
+ */
+template <typename... Ts> auto run_deferred() -> std::size_t {
+    auto &q = deferred_work<Ts...>;
+    return q.run();
+}
+} // namespace interrupt
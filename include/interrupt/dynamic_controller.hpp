@@ -6,8 +6,14 @@
 #include <stdx/tuple.hpp>
 #include <stdx/tuple_algorithms.hpp>
 
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
+#include <utility>
 
 namespace interrupt {
 enum class resource_status { OFF = 0, ON = 1 };
@@ -15,8 +21,84 @@ enum class resource_status { OFF = 0, ON = 1 };
 template <typename Irq>
 constexpr static auto has_enable_field = requires { Irq::enable_field; };
 
+/**
+ * Update interrupt enables inside conc::call_in_critical_section. This is the
+ * default.
+ */
+struct critical_section_updates {};
+
+/**
+ * Update interrupt enables without a critical section.
+ *
+ * The enable and resource state is kept in atomics and changed with atomic
+ * read-modify-write operations. Each enable register has a sequence counter
+ * that is bumped whenever its state changes; a core that writes the register
+ * and then finds that the counter has moved recomputes the value and writes it
+ * again. So concurrent updates from several cores converge on the right
+ * register value without serializing on one lock, at the cost of an
+ * occasional redundant write.
+ *
+ * This requires lock-free atomics for the register data type, and enable
+ * registers that can be written with a single store.
+ */
+struct lock_free_updates {};
+
+/**
+ * The update policy of the dynamic_controller for an interrupt configuration.
+ * To change it, specialize this variable:
+ *
+ *     template <>
+ *     constexpr auto interrupt::dynamic_update_policy<my_config> =
+ *         interrupt::lock_free_updates{};
+ */
+template <typename RootT>
+constexpr auto dynamic_update_policy = critical_section_updates{};
+
 template <typename RootT> struct dynamic_controller {
   private:
+    constexpr static bool lock_free =
+        std::is_same_v<std::remove_cvref_t<decltype(dynamic_update_policy<
+                                                    RootT>)>,
+                       lock_free_updates>;
+
+    template <typename T>
+    using state_t = std::conditional_t<lock_free, std::atomic<T>, T>;
+
+    template <typename T> static auto load(state_t<T> const &s) -> T {
+        if constexpr (lock_free) {
+            return s.load();
+        } else {
+            return s;
+        }
+    }
+
+    template <typename T> static auto store(state_t<T> &s, T value) -> void {
+        if constexpr (lock_free) {
+            s.store(value);
+        } else {
+            s = value;
+        }
+    }
+
+    template <typename T> static auto exchange(state_t<T> &s, T value) -> T {
+        if constexpr (lock_free) {
+            return s.exchange(value);
+        } else {
+            auto const old = s;
+            s = value;
+            return old;
+        }
+    }
+
+    template <typename F> static auto update(F &&f) -> void {
+        if constexpr (lock_free) {
+            std::forward<F>(f)();
+        } else {
+            conc::call_in_critical_section<dynamic_controller>(
+                std::forward<F>(f));
+        }
+    }
+
     /**
      * Store the interrupt enable values that are allowed given the current set
      * of resources that are available.
@@ -25,14 +107,24 @@ template <typename RootT> struct dynamic_controller {
      *      The croo::Register this mask corresponds to.
      */
     template <typename RegType>
-    CONSTINIT static inline typename RegType::DataType allowed_enables =
-        std::numeric_limits<typename RegType::DataType>::max();
+    CONSTINIT static inline state_t<typename RegType::DataType>
+        allowed_enables = std::numeric_limits<typename RegType::DataType>::max();
 
-    template <typename ResourceType> struct doesnt_require_resource {
+    /**
+     * Bumped after each change to the allowed or dynamic enables of RegType.
+     * Only used with lock_free_updates.
+     *
+     * @tparam RegType
+     *      The croo::Register this counter corresponds to.
+     */
+    template <typename RegType>
+    CONSTINIT static inline std::atomic<std::uint32_t> sequence{};
+
+    template <typename ResourceType> struct requires_resource {
         template <typename Irq>
         using fn = std::bool_constant<
             has_enable_field<Irq> and
-            not stdx::contains_type<decltype(Irq::resources), ResourceType>>;
+            stdx::contains_type<decltype(Irq::resources), ResourceType>>;
     };
 
     template <typename RegType> struct in_register {
@@ -41,14 +133,12 @@ template <typename RootT> struct dynamic_controller {
     };
 
     /**
-     * For each ResourceType, keep track of what interrupts can still be enabled
+     * For each ResourceType, keep track of what interrupts must be disabled
      * when that resource goes down.
      *
      * Each bit in this mask corresponds to an interrupt enable field in
-     * RegType. If the bit is '1', that means the corresponding interrupt can be
-     * enabled when the resource is not available. If the bit is '0', that means
-     * the corresponding interrupt must be disabled when the resource is not
-     * available.
+     * RegType. If the bit is '1', that means the corresponding interrupt must
+     * be disabled when the resource is not available.
      *
      * @tparam ResourceType
      *      The resource we want to check.
@@ -57,10 +147,10 @@ template <typename RootT> struct dynamic_controller {
      *      The specific register mask we want to check.
      */
     template <typename ResourceType, typename RegType>
-    constexpr static typename RegType::DataType irqs_allowed = []() {
-        // get all interrupt enable fields that don't require the given resource
+    constexpr static typename RegType::DataType irqs_blocked = []() {
+        // get all interrupt enable fields that require the given resource
         auto const matching_irqs =
-            stdx::filter<doesnt_require_resource<ResourceType>::template fn>(
+            stdx::filter<requires_resource<ResourceType>::template fn>(
                 RootT::all_irqs);
         auto const interrupt_enables_tuple = stdx::transform(
             [](auto irq) { return irq.enable_field; }, matching_irqs);
@@ -70,8 +160,7 @@ template <typename RootT> struct dynamic_controller {
             stdx::filter<in_register<RegType>::template fn>(
                 interrupt_enables_tuple);
 
-        // set the bits in the mask for interrupts that don't require the
-        // resource
+        // set the bits in the mask for interrupts that require the resource
         using DataType = typename RegType::DataType;
         return fields_in_reg.fold_left(
             DataType{}, [](DataType value, auto field) -> DataType {
@@ -79,22 +168,81 @@ template <typename RootT> struct dynamic_controller {
             });
     }();
 
+    /**
+     * For each bit of RegType, count the resources that are off and are
+     * required by the interrupt enabled by that bit. The interrupt is allowed
+     * to be enabled only when its count is zero.
+     *
+     * @tparam RegType
+     *      The croo::Register these counts correspond to.
+     */
+    template <typename RegType>
+    CONSTINIT static inline std::array<
+        state_t<std::uint8_t>,
+        std::numeric_limits<typename RegType::DataType>::digits>
+        blocking_resources{};
+
     template <typename ResourceType>
-    CONSTINIT static inline bool is_resource_on = true;
+    CONSTINIT static inline state_t<bool> is_resource_on = true;
+
+    template <typename RegType> struct shadow_register {
+        state_t<typename RegType::DataType> value{};
+        state_t<bool> valid{};
+    };
+
+    /**
+     * The value last written to each interrupt enable register, so that
+     * writes that would not change the register can be skipped. This assumes
+     * nothing else writes these registers. It is updated only after the
+     * register has been written, so that no update returns before the value
+     * it skipped writing is in the register.
+     *
+     * @tparam RegType
+     *      The croo::Register this value corresponds to.
+     */
+    template <typename RegType>
+    CONSTINIT static inline shadow_register<RegType> written_enables{};
+
+    template <typename RegType>
+    static inline void program_interrupt_enables(RegType reg, bool force) {
+        using DataType = typename RegType::DataType;
+
+        // make sure we don't enable any interrupts that are not allowed
+        // according to resource availability
+        auto const final_enables =
+            static_cast<DataType>(load<DataType>(allowed_enables<RegType>) &
+                                  load<DataType>(dynamic_enables<RegType>));
+
+        // update the hardware registers, if they would change
+        auto &shadow = written_enables<RegType>;
+        if (not force and load<bool>(shadow.valid) and
+            load<DataType>(shadow.value) == final_enables) {
+            return;
+        }
+        apply(write(reg.raw(final_enables)));
+        store<DataType>(shadow.value, final_enables);
+        store<bool>(shadow.valid, true);
+    }
 
     template <typename RegTypeTuple>
     static inline void reprogram_interrupt_enables(RegTypeTuple regs) {
         stdx::for_each(
             [](auto reg) {
                 using RegType = decltype(reg);
-
-                // make sure we don't enable any interrupts that are not allowed
-                // according to resource availability
-                auto const final_enables =
-                    allowed_enables<RegType> & dynamic_enables<RegType>;
-
-                // update the hardware registers
-                apply(write(reg.raw(final_enables)));
+                if constexpr (lock_free) {
+                    // if the state changed while the register was being
+                    // written, the value written may be stale: write it again
+                    auto &seq = sequence<RegType>;
+                    for (auto force = false;; force = true) {
+                        auto const s = seq.load();
+                        program_interrupt_enables(reg, force);
+                        if (seq.load() == s) {
+                            break;
+                        }
+                    }
+                } else {
+                    program_interrupt_enables(reg, false);
+                }
             },
             regs);
     }
@@ -114,24 +262,6 @@ template <typename RootT> struct dynamic_controller {
         });
     }
 
-    template <typename ResourceTuple> struct not_in {
-        template <typename Resource>
-        using fn = std::bool_constant<
-            not stdx::contains_type<ResourceTuple, Resource>>;
-    };
-
-    /**
-     * tuple of every resource mentioned in the interrupt configuration
-     */
-    constexpr static auto all_resources = RootT::all_irqs.fold_left(
-        stdx::make_tuple(), [](auto resources, auto irq) {
-            // TODO: check that an IRQ doesn't list a resource more than once
-            auto const additional_resources =
-                stdx::filter<not_in<decltype(resources)>::template fn>(
-                    irq.resources);
-            return stdx::tuple_cat(resources, additional_resources);
-        });
-
     /**
      * tuple of every interrupt register affected by a resource
      */
@@ -150,36 +280,94 @@ template <typename RootT> struct dynamic_controller {
                 }
             }));
 
+    template <typename ResourceType> struct blocked_by {
+        template <typename RegType>
+        using fn =
+            std::bool_constant<irqs_blocked<ResourceType, RegType> != 0>;
+    };
+
+    /**
+     * tuple of every interrupt register affected by ResourceType
+     */
+    template <typename ResourceType>
+    constexpr static auto resource_affected_regs =
+        stdx::filter<blocked_by<ResourceType>::template fn>(
+            all_resource_affected_regs);
+
     /**
-     * Reprogram interrupt enables based on updated resource availability.
+     * Set or clear one bit of the allowed enables to match its count of
+     * blocking resources. The count may change between reading it and
+     * storing the bit, and a concurrent update of the same bit may store
+     * nothing new, so the count is read again after the store: if it no
+     * longer agrees with the stored bit, the bit is synced again.
      */
-    static inline auto recalculate_allowed_enables() {
-        // set allowed_enables mask for each resource affected register
+    template <typename RegType>
+    static inline auto sync_allowed_enable(std::size_t bit) -> void {
+        using DataType = typename RegType::DataType;
+
+        auto const mask = static_cast<DataType>(DataType{1} << bit);
+        auto &allowed = allowed_enables<RegType>;
+        auto const &count = blocking_resources<RegType>[bit];
+        auto current = allowed.load();
+        auto blocked = false;
+        do {
+            auto desired = DataType{};
+            do {
+                blocked = count.load() != 0;
+                desired = blocked ? static_cast<DataType>(current & ~mask)
+                                  : static_cast<DataType>(current | mask);
+            } while (not allowed.compare_exchange_weak(current, desired));
+            current = desired;
+        } while ((count.load() != 0) != blocked);
+    }
+
+    /**
+     * Update the allowed enables after ResourceType has been turned on or
+     * off. Only the registers holding interrupts that require ResourceType
+     * are touched.
+     */
+    template <typename ResourceType>
+    static inline auto update_allowed_enables(bool on) {
         stdx::for_each(
-            [](auto reg) {
+            [=](auto reg) {
                 using RegType = decltype(reg);
                 using DataType = typename RegType::DataType;
-                allowed_enables<RegType> = std::numeric_limits<DataType>::max();
-            },
-            all_resource_affected_regs);
 
-        // for each resource, if it is not on, mask out unavailable interrupts
-        stdx::for_each(
-            [=](auto resource) {
-                using ResourceType = decltype(resource);
-                if (not is_resource_on<ResourceType>) {
-                    stdx::for_each(
-                        [](auto reg) {
-                            using RegType = decltype(reg);
+                auto &counts = blocking_resources<RegType>;
+                auto bits = irqs_blocked<ResourceType, RegType>;
+                while (bits != 0) {
+                    auto const bit =
+                        static_cast<std::size_t>(std::countr_zero(bits));
+                    auto const mask = static_cast<DataType>(DataType{1} << bit);
+                    if constexpr (lock_free) {
+                        // a count may briefly wrap when a resource is turned
+                        // on and off concurrently; it settles once both
+                        // updates are done
+                        if (on) {
+                            counts[bit].fetch_sub(1);
+                        } else {
+                            counts[bit].fetch_add(1);
+                        }
+                        sync_allowed_enable<RegType>(bit);
+                    } else if (on) {
+                        if (--counts[bit] == 0) {
+                            allowed_enables<RegType> |= mask;
+                        }
+                    } else {
+                        if (counts[bit]++ == 0) {
                             allowed_enables<RegType> &=
-                                irqs_allowed<ResourceType, RegType>;
-                        },
-                        all_resource_affected_regs);
+                                static_cast<DataType>(~mask);
+                        }
+                    }
+                    bits &= static_cast<DataType>(bits - 1u);
+                }
+                if constexpr (lock_free) {
+                    sequence<RegType>.fetch_add(1);
                 }
             },
-            all_resources);
+            resource_affected_regs<ResourceType>);
 
-        return all_resource_affected_regs;
+        return resource_affected_regs<ResourceType>;
     }
 
     /**
@@ -191,7 +379,8 @@ template <typename RootT> struct dynamic_controller {
      *      The croo::Register this value corresponds to.
      */
     template <typename RegType>
-    CONSTINIT static inline typename RegType::DataType dynamic_enables{};
+    CONSTINIT static inline state_t<typename RegType::DataType>
+        dynamic_enables{};
 
     template <typename... Callbacks> struct match_callback {
         template <typename Irq>
@@ -224,10 +413,13 @@ template <typename RootT> struct dynamic_controller {
   public:
     template <typename ResourceType>
     static inline void update_resource(resource_status status) {
-        conc::call_in_critical_section<dynamic_controller>([&] {
-            is_resource_on<ResourceType> = (status == resource_status::ON);
-            recalculate_allowed_enables();
-            reprogram_interrupt_enables(all_resource_affected_regs);
+        update([&] {
+            auto const on = status == resource_status::ON;
+            if (exchange<bool>(is_resource_on<ResourceType>, on) == on) {
+                return;
+            }
+            reprogram_interrupt_enables(
+                update_allowed_enables<ResourceType>(on));
         });
     }
 
@@ -243,7 +435,7 @@ template <typename RootT> struct dynamic_controller {
     static inline void enable_by_field() {
         auto const interrupt_enables_tuple = stdx::tuple<FieldsToSet...>{};
 
-        conc::call_in_critical_section<dynamic_controller>([&] {
+        update([&] {
             stdx::for_each(
                 [](auto f) {
                     using RegType = decltype(f.get_register());
@@ -256,6 +448,13 @@ template <typename RootT> struct dynamic_controller {
                 interrupt_enables_tuple);
 
             auto const unique_regs = get_unique_regs(interrupt_enables_tuple);
+            if constexpr (lock_free) {
+                stdx::for_each(
+                    []<typename RegType>(RegType) {
+                        sequence<RegType>.fetch_add(1);
+                    },
+                    unique_regs);
+            }
             reprogram_interrupt_enables(unique_regs);
         });
     }
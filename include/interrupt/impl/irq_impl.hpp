@@ -34,6 +34,8 @@ template <typename ConfigT, typename FlowTypeT> struct irq_impl {
     constexpr static bool active = FlowTypeT::active;
 
   private:
+    using ExecutionPolicy = typename ConfigT::ExecutionPolicy;
+
     FunctionPtr interrupt_service_routine;
 
   public:
@@ -69,7 +71,8 @@ template <typename ConfigT, typename FlowTypeT> struct irq_impl {
     template <typename InterruptHal> inline void run() const {
         if constexpr (active) {
             InterruptHal::template run<StatusPolicy>(
-                irq_number, [&]() { interrupt_service_routine(); });
+                irq_number,
+                [&]() { ExecutionPolicy::run(interrupt_service_routine); });
         }
     }
 };
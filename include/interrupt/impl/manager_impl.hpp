@@ -1,11 +1,14 @@
 #pragma once
 
+#include <interrupt/fwd.hpp>
+#include <interrupt/instrumentation.hpp>
 #include <interrupt/manager_interface.hpp>
 
 #include <stdx/tuple.hpp>
 #include <stdx/tuple_algorithms.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <type_traits>
 #include <utility>
@@ -30,6 +33,10 @@ class manager_impl : public manager_interface {
   private:
     stdx::tuple<IrqImplTypes...> irq_impls;
 
+    // the leading zero keeps a manager with no irqs well-formed
+    constexpr static std::size_t max_irq_number =
+        std::max({std::size_t{}, IrqImplTypes::irq_number...});
+
     template <std::size_t Key, typename Value> struct irq_pair {};
     template <typename... Ts> struct irq_map : Ts... {};
 
@@ -82,6 +89,8 @@ class manager_impl : public manager_interface {
      * The microcontroller's interrupt vector table should be configured to call
      * this method for each IRQ it supports.
      *
+     * If interrupt::instrumentation is enabled, each run is counted and timed.
+     *
      * @tparam IrqNumber
      *      The IRQ number that has been triggered by hardware.
      */
@@ -90,7 +99,9 @@ class manager_impl : public manager_interface {
         using irq_t = decltype(lookup<IrqNumber, void>(std::declval<M>()));
 
         if constexpr (not std::is_void_v<irq_t>) {
-            get<irq_t>(irq_impls).template run<InterruptHal>();
+            measure<irq_key<IrqNumber>>([&] {
+                get<irq_t>(irq_impls).template run<InterruptHal>();
+            });
         }
     }
 
@@ -98,7 +109,55 @@ class manager_impl : public manager_interface {
      * @return The highest active IRQ number.
      */
     [[nodiscard]] constexpr auto max_irq() const -> std::size_t {
-        return std::max({IrqImplTypes::irq_number...});
+        return max_irq_number;
+    }
+
+    /**
+     * Build an interrupt vector table with a direct entry point for each
+     * active IRQ.
+     *
+     * The table is indexed by IRQ number. Each active IRQ's entry calls
+     * run<IrqNumber>() on Manager; every other entry is DefaultHandler. The
+     * table is a constant, so it can be placed in ROM.
+     *
+     * @tparam Manager
+     *      The manager_impl instance to run, e.g. a nexus service.
+     *
+     * @tparam DefaultHandler
+     *      The handler for IRQ numbers that have no active irq.
+     *
+     * @see interrupt::vector_table
+     */
+    template <auto const &Manager, FunctionPtr DefaultHandler>
+    [[nodiscard]] constexpr static auto make_vector_table()
+        -> std::array<FunctionPtr, max_irq_number + 1> {
+        std::array<FunctionPtr, max_irq_number + 1> table{};
+        table.fill(DefaultHandler);
+        (
+            [&] {
+                if constexpr (IrqImplTypes::active) {
+                    table[IrqImplTypes::irq_number] =
+                        entry<Manager, IrqImplTypes::irq_number>;
+                }
+            }(),
+            ...);
+        return table;
+    }
+
+  private:
+    template <auto const &Manager, std::size_t IrqNumber>
+    static auto entry() -> void {
+        Manager.template run<IrqNumber>();
     }
 };
+
+/**
+ * The interrupt vector table for a manager_impl instance.
+ *
+ * @see manager_impl::make_vector_table
+ */
+template <auto const &Manager, FunctionPtr DefaultHandler>
+constexpr auto vector_table =
+    std::remove_cvref_t<decltype(Manager)>::template make_vector_table<
+        Manager, DefaultHandler>();
 } // namespace interrupt
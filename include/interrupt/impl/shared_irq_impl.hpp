@@ -1,6 +1,7 @@
 #pragma once
 
 #include <interrupt/config/fwd.hpp>
+#include <interrupt/impl/sub_irq_dispatch.hpp>
 
 #include <stdx/tuple.hpp>
 #include <stdx/tuple_algorithms.hpp>
@@ -69,6 +70,9 @@ template <typename ConfigT, typename... SubIrqImpls> struct shared_irq_impl {
      * pending interrupt. Clear any hardware interrupt pending bits as
      * necessary.
      *
+     * Each enable and status register is read once per interrupt, however
+     * many sub_irq::impls it holds fields for.
+     *
      * This should be used only by interrupt::Manager.
      *
      * @tparam InterruptHal
@@ -78,7 +82,8 @@ template <typename ConfigT, typename... SubIrqImpls> struct shared_irq_impl {
     template <typename InterruptHal> inline void run() const {
         if constexpr (active) {
             InterruptHal::template run<StatusPolicy>(irq_number, [&] {
-                stdx::for_each([](auto irq) { irq.run(); }, sub_irq_impls);
+                detail::sub_irq_dispatcher<SubIrqImpls...>::dispatch(
+                    sub_irq_impls);
             });
         }
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <interrupt/config/fwd.hpp>
+#include <interrupt/impl/sub_irq_dispatch.hpp>
 
 #include <stdx/tuple.hpp>
 #include <stdx/tuple_algorithms.hpp>
@@ -20,15 +21,16 @@ struct shared_sub_irq_impl {
      */
     constexpr static bool active = (SubIrqImpls::active or ...);
 
+    constexpr static auto enable_field = ConfigT::enable_field;
+    constexpr static auto status_field = ConfigT::status_field;
+    using StatusPolicy = typename ConfigT::StatusPolicy;
+    constexpr static auto priority = ConfigT::priority;
+
   private:
     template <typename InterruptHal, bool en>
     constexpr static EnableActionType enable_action =
         ConfigT::template enable_action<InterruptHal, en>;
 
-    constexpr static auto enable_field = ConfigT::enable_field;
-    constexpr static auto status_field = ConfigT::status_field;
-    using StatusPolicy = typename ConfigT::StatusPolicy;
-
     stdx::tuple<SubIrqImpls...> sub_irq_impls;
 
     template <typename Irq> using is_active = std::bool_constant<Irq::active>;
@@ -56,16 +58,25 @@ struct shared_sub_irq_impl {
      * Evaluate interrupt status of each sub_irq::impl and run each one with a
      * pending interrupt. Clear any hardware interrupt pending bits as
      * necessary.
+     *
+     * The registers of the sub_irq::impls are read once. Those that the
+     * parent irq has already read are not read again.
+     *
+     * @param registers
+     *      The values of the enable and status registers, already read by the
+     * parent irq.
      */
-    inline void run() const {
+    template <typename Registers>
+    inline void run(Registers const &registers) const {
         if constexpr (active) {
-            if (apply(read(enable_field(1))) && apply(read(status_field(1)))) {
-                StatusPolicy::run([&] { apply(clear(status_field)); },
-                                  [&] {
-                                      stdx::for_each(
-                                          [](auto irq) { irq.run(); },
-                                          sub_irq_impls);
-                                  });
+            if (registers.is_set(enable_field) and
+                registers.is_set(status_field)) {
+                StatusPolicy::run(
+                    [&] { apply(clear(status_field)); },
+                    [&] {
+                        detail::sub_irq_dispatcher<SubIrqImpls...>::dispatch(
+                            sub_irq_impls, registers);
+                    });
             }
         }
     }
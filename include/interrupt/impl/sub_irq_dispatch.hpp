@@ -0,0 +1,364 @@
+#pragma once
+
+#include <interrupt/policies.hpp>
+
+#include <stdx/tuple.hpp>
+#include <stdx/tuple_algorithms.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace interrupt::detail {
+template <typename Field>
+using register_of = typename std::remove_cvref_t<Field>::RegisterType;
+
+template <typename Reg> struct register_value {
+    typename Reg::DataType value;
+};
+
+/**
+ * The values of a set of registers, each read exactly once.
+ */
+template <typename... Regs> struct register_cache {
+    stdx::tuple<register_value<Regs>...> values;
+
+    template <typename Reg>
+    constexpr static bool contains = (std::is_same_v<Reg, Regs> or ...);
+
+    template <typename Reg>
+    [[nodiscard]] auto value_of() const -> typename Reg::DataType {
+        return get<register_value<Reg>>(values).value;
+    }
+
+    template <typename Field>
+    [[nodiscard]] auto is_set(Field const &field) const -> bool {
+        return (value_of<register_of<Field>>() & field.get_mask()) != 0;
+    }
+};
+
+template <typename FieldTuple>
+constexpr auto get_unique_regs(FieldTuple fields) {
+    return fields.fold_left(stdx::make_tuple(), [](auto regs, auto field) {
+        constexpr bool reg_has_been_seen_already =
+            stdx::contains_type<decltype(regs), register_of<decltype(field)>>;
+        if constexpr (reg_has_been_seen_already) {
+            return regs;
+        } else {
+            return stdx::tuple_cat(regs,
+                                   stdx::make_tuple(field.get_register()));
+        }
+    });
+}
+
+template <typename Reg, typename... CachedRegs>
+auto read_register(register_cache<CachedRegs...> const &cache) ->
+    typename Reg::DataType {
+    if constexpr (register_cache<CachedRegs...>::template contains<Reg>) {
+        return cache.template value_of<Reg>();
+    } else {
+        return static_cast<typename Reg::DataType>(apply(read(Reg::raw)));
+    }
+}
+
+/**
+ * Read a set of registers, except those whose values have already been read
+ * into the given cache.
+ */
+template <typename... Regs, typename Cache = register_cache<>>
+auto read_registers(stdx::tuple<Regs...> const &, Cache const &cache = {})
+    -> register_cache<Regs...> {
+    return {{register_value<Regs>{read_register<Regs>(cache)}...}};
+}
+
+/**
+ * A sub_irq can be dispatched by bit position when its enable and status
+ * fields are the same single bit in their respective registers. All such
+ * sub_irqs sharing an enable and a status register can then be checked at
+ * once.
+ */
+template <typename Irq> constexpr auto is_bit_dispatchable() -> bool {
+    if constexpr (Irq::active and requires { &Irq::run_pending; }) {
+        using enable_reg = register_of<decltype(Irq::enable_field)>;
+        using status_reg = register_of<decltype(Irq::status_field)>;
+        constexpr auto mask = Irq::status_field.get_mask();
+        return std::is_same_v<typename enable_reg::DataType,
+                              typename status_reg::DataType> and
+               Irq::enable_field.get_mask() == mask and
+               std::has_single_bit(mask);
+    } else {
+        return false;
+    }
+}
+
+template <typename Policy, typename When>
+constexpr bool is_batched_clear = false;
+template <typename When>
+constexpr bool is_batched_clear<clear_status_batched<When>, When> = true;
+
+template <typename Irq>
+constexpr bool clears_status_batched =
+    is_batched_clear<typename Irq::StatusPolicy, clear_status_first> or
+    is_batched_clear<typename Irq::StatusPolicy, clear_status_last>;
+
+template <typename EnableReg, typename StatusReg> struct register_pair {
+    using enable_register = EnableReg;
+    using status_register = StatusReg;
+};
+
+template <typename Irq>
+using register_pair_of = register_pair<register_of<decltype(Irq::enable_field)>,
+                                       register_of<decltype(Irq::status_field)>>;
+
+/**
+ * Check and run the sub_irqs of a shared_irq or shared_sub_irq.
+ *
+ * Every register holding an enable or status field of an active sub_irq is
+ * read once. sub_irqs that are dispatchable by bit position are grouped by
+ * register at compile time: for each group the enable and status values are
+ * ANDed together and only the set bits are visited. Any other sub_irq is
+ * checked individually against the register values already read.
+ *
+ * Pending sub_irqs are run in order of their dispatch_priority, highest first.
+ * The status bits of pending sub_irqs with the clear_status_batched policy are
+ * cleared with one write per group.
+ */
+template <typename... SubIrqImpls> struct sub_irq_dispatcher {
+  private:
+    using impls_t = stdx::tuple<SubIrqImpls...>;
+    using handler_t = auto (*)(impls_t const &) -> void;
+
+    template <std::size_t I>
+    using nth_t = std::tuple_element_t<I, std::tuple<SubIrqImpls...>>;
+
+    template <typename Irq> constexpr static auto fields_of() {
+        if constexpr (Irq::active) {
+            return stdx::make_tuple(Irq::enable_field, Irq::status_field);
+        } else {
+            return stdx::make_tuple();
+        }
+    }
+
+    template <typename Irq> constexpr static auto group_of() {
+        if constexpr (is_bit_dispatchable<Irq>()) {
+            return stdx::make_tuple(register_pair_of<Irq>{});
+        } else {
+            return stdx::make_tuple();
+        }
+    }
+
+    constexpr static auto registers =
+        get_unique_regs(stdx::tuple_cat(fields_of<SubIrqImpls>()...));
+
+    constexpr static auto groups =
+        stdx::tuple_cat(group_of<SubIrqImpls>()...)
+            .fold_left(stdx::make_tuple(), [](auto gs, auto g) {
+                if constexpr (stdx::contains_type<decltype(gs),
+                                                  decltype(g)>) {
+                    return gs;
+                } else {
+                    return stdx::tuple_cat(gs, stdx::make_tuple(g));
+                }
+            });
+
+    template <std::size_t I>
+    static auto run_pending(impls_t const &impls) -> void {
+        get<I>(impls).run_pending();
+    }
+
+    template <typename Group> struct dispatch_table {
+        using data_t = typename Group::status_register::DataType;
+
+        data_t mask{};
+        data_t clear_first{};
+        data_t clear_last{};
+        std::array<handler_t, std::numeric_limits<data_t>::digits> handlers{};
+    };
+
+    template <typename Group, typename F>
+    constexpr static auto for_each_in_group(F &&f) -> void {
+        [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            (
+                [&] {
+                    using irq_t = nth_t<Is>;
+                    if constexpr (is_bit_dispatchable<irq_t>()) {
+                        if constexpr (std::is_same_v<register_pair_of<irq_t>,
+                                                     Group>) {
+                            f(std::integral_constant<std::size_t, Is>{});
+                        }
+                    }
+                }(),
+                ...);
+        }(std::index_sequence_for<SubIrqImpls...>{});
+    }
+
+    template <typename Group> constexpr static auto make_dispatch_table() {
+        dispatch_table<Group> t{};
+        for_each_in_group<Group>(
+            [&]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+                using irq_t = nth_t<I>;
+                constexpr auto mask = irq_t::status_field.get_mask();
+                t.mask |= mask;
+                using policy_t = typename irq_t::StatusPolicy;
+                if constexpr (is_batched_clear<policy_t, clear_status_first>) {
+                    t.clear_first |= mask;
+                } else if constexpr (is_batched_clear<policy_t,
+                                                      clear_status_last>) {
+                    t.clear_last |= mask;
+                }
+                t.handlers[static_cast<std::size_t>(std::countr_zero(mask))] =
+                    run_pending<I>;
+            });
+        return t;
+    }
+
+    template <typename Group>
+    constexpr static auto table = make_dispatch_table<Group>();
+
+    template <typename Group, int Priority>
+    constexpr static auto make_priority_mask() {
+        typename dispatch_table<Group>::data_t mask{};
+        for_each_in_group<Group>(
+            [&]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+                if constexpr (nth_t<I>::priority == Priority) {
+                    mask |= nth_t<I>::status_field.get_mask();
+                }
+            });
+        return mask;
+    }
+
+    template <typename Group, int Priority>
+    constexpr static auto priority_mask = make_priority_mask<Group, Priority>();
+
+    // the distinct priorities of the active sub_irqs, highest first
+    struct priority_levels {
+        std::array<int, sizeof...(SubIrqImpls)> values{};
+        std::size_t size{};
+    };
+
+    constexpr static auto levels = [] {
+        priority_levels l{};
+        auto const add = [&](int priority) {
+            auto const last = std::next(std::begin(l.values),
+                                        static_cast<std::ptrdiff_t>(l.size));
+            if (std::find(std::begin(l.values), last, priority) == last) {
+                l.values[l.size++] = priority;
+            }
+        };
+        (
+            [&] {
+                if constexpr (SubIrqImpls::active) {
+                    add(SubIrqImpls::priority);
+                }
+            }(),
+            ...);
+        std::sort(std::begin(l.values),
+                  std::next(std::begin(l.values),
+                            static_cast<std::ptrdiff_t>(l.size)),
+                  std::greater{});
+        return l;
+    }();
+
+    template <typename Reg, typename T>
+    static auto clear_status(T bits) -> void {
+        if (bits != 0) {
+            apply(write(Reg::raw(bits)));
+        }
+    }
+
+    template <typename Group, typename Cache>
+    static auto pending(Cache const &cache) {
+        using enable_reg = typename Group::enable_register;
+        using status_reg = typename Group::status_register;
+        using data_t = typename status_reg::DataType;
+
+        return static_cast<data_t>(cache.template value_of<enable_reg>() &
+                                   cache.template value_of<status_reg>() &
+                                   table<Group>.mask);
+    }
+
+    template <int Priority, typename Cache>
+    static auto dispatch_priority_level(impls_t const &impls,
+                                        Cache const &cache) -> void {
+        stdx::for_each(
+            [&]<typename Group>(Group) {
+                using data_t = typename Group::status_register::DataType;
+
+                auto bits = static_cast<data_t>(pending<Group>(cache) &
+                                                priority_mask<Group, Priority>);
+                while (bits != 0) {
+                    auto const bit =
+                        static_cast<std::size_t>(std::countr_zero(bits));
+                    table<Group>.handlers[bit](impls);
+                    bits &= static_cast<data_t>(bits - 1u);
+                }
+            },
+            groups);
+
+        stdx::for_each(
+            [&]<typename Irq>(Irq const &irq) {
+                if constexpr (Irq::active and
+                              not is_bit_dispatchable<Irq>()) {
+                    static_assert(not clears_status_batched<Irq>,
+                                  "clear_status_batched requires the enable "
+                                  "and status fields of a sub_irq to be the "
+                                  "same single bit");
+                    if constexpr (Irq::priority == Priority) {
+                        irq.run(cache);
+                    }
+                }
+            },
+            impls);
+    }
+
+    template <typename Cache>
+    static auto dispatch_cached(impls_t const &impls, Cache const &cache)
+        -> void {
+        stdx::for_each(
+            [&]<typename Group>(Group) {
+                if constexpr (table<Group>.clear_first != 0) {
+                    using status_reg = typename Group::status_register;
+                    clear_status<status_reg>(pending<Group>(cache) &
+                                             table<Group>.clear_first);
+                }
+            },
+            groups);
+
+        [&]<std::size_t... Ls>(std::index_sequence<Ls...>) {
+            (dispatch_priority_level<levels.values[Ls]>(impls, cache), ...);
+        }(std::make_index_sequence<levels.size>{});
+
+        stdx::for_each(
+            [&]<typename Group>(Group) {
+                if constexpr (table<Group>.clear_last != 0) {
+                    using status_reg = typename Group::status_register;
+                    clear_status<status_reg>(pending<Group>(cache) &
+                                             table<Group>.clear_last);
+                }
+            },
+            groups);
+    }
+
+  public:
+    static auto dispatch(impls_t const &impls) -> void {
+        dispatch_cached(impls, read_registers(registers));
+    }
+
+    /**
+     * Dispatch the sub_irqs of a shared_sub_irq. Registers that its parent
+     * has already read are not read again.
+     */
+    template <typename ParentCache>
+    static auto dispatch(impls_t const &impls, ParentCache const &parent)
+        -> void {
+        dispatch_cached(impls, read_registers(registers, parent));
+    }
+};
+} // namespace interrupt::detail
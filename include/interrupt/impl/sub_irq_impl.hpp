@@ -1,6 +1,7 @@
 #pragma once
 
 #include <interrupt/fwd.hpp>
+#include <interrupt/instrumentation.hpp>
 
 #include <stdx/tuple.hpp>
 
@@ -25,10 +26,13 @@ template <typename ConfigT, typename FlowTypeT> struct sub_irq_impl {
      */
     constexpr static bool active = FlowTypeT::active;
 
-  private:
     constexpr static auto enable_field = ConfigT::enable_field;
     constexpr static auto status_field = ConfigT::status_field;
     using StatusPolicy = typename ConfigT::StatusPolicy;
+    constexpr static auto priority = ConfigT::priority;
+
+  private:
+    using ExecutionPolicy = typename ConfigT::ExecutionPolicy;
 
     FunctionPtr interrupt_service_routine;
 
@@ -41,22 +45,40 @@ template <typename ConfigT, typename FlowTypeT> struct sub_irq_impl {
     }
 
     /**
-     * Run the interrupt service routine and clear any pending interrupt status.
-     * This includes checking and clearing the interrupt status register field.
+     * Run the interrupt service routine and clear any pending interrupt status
+     * if the sub_irq is enabled and pending.
      *
      * This should be used only by interrupt::Manager.
      *
-     * @tparam InterruptHal
-     *      The hardware abstraction layer that knows how to clear pending
-     * interrupt status.
+     * @param registers
+     *      The values of the enable and status registers, already read by the
+     * parent irq.
      */
-    inline void run() const {
+    template <typename Registers>
+    inline void run(Registers const &registers) const {
         if constexpr (active) {
-            if (apply(read(enable_field)) && apply(read(status_field))) {
-                StatusPolicy::run([&] { apply(clear(status_field)); },
-                                  [&] { interrupt_service_routine(); });
+            if (registers.is_set(enable_field) and
+                registers.is_set(status_field)) {
+                run_pending();
             }
         }
     }
+
+    /**
+     * Run the interrupt service routine and clear the interrupt status field,
+     * without checking it. The parent irq has already determined that the
+     * sub_irq is enabled and pending.
+     *
+     * If interrupt::instrumentation is enabled, each run is counted and timed.
+     */
+    inline void run_pending() const {
+        measure<sub_irq_key<typename ConfigT::IrqCallbackType>>([&] {
+            StatusPolicy::run([&] { apply(clear(status_field)); },
+                              [&] {
+                                  ExecutionPolicy::run(
+                                      interrupt_service_routine);
+                              });
+        });
+    }
 };
 } // namespace interrupt
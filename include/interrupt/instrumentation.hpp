@@ -0,0 +1,163 @@
+#pragma once
+
+#include <flow/builder.hpp>
+#include <log/log.hpp>
+#include <sc/fwd.hpp>
+
+#include <stdx/compiler.hpp>
+#include <stdx/tuple_algorithms.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace interrupt {
+/**
+ * A snapshot of the occurrence and timing statistics for one irq or sub_irq.
+ *
+ * Durations are in the units of the timestamp HAL. The duration of an irq
+ * includes the time spent in any interrupt that preempted it.
+ */
+struct irq_stats {
+    std::uint32_t count{};
+    std::uint64_t max_duration{};
+    std::uint64_t total_duration{};
+};
+
+template <std::size_t IrqNumber> struct irq_key {};
+template <typename IrqCallback> struct sub_irq_key {};
+
+namespace detail {
+/**
+ * The live statistics for one irq or sub_irq.
+ *
+ * They are only written by the interrupt service routine being measured,
+ * which cannot preempt itself, so each field is updated with a relaxed load
+ * and store rather than a read-modify-write. Readers in other contexts see
+ * each field atomically, but a snapshot taken while the routine runs may mix
+ * fields from consecutive runs.
+ */
+struct irq_counters {
+    std::atomic<std::uint32_t> count{};
+    std::atomic<std::uint64_t> max_duration{};
+    std::atomic<std::uint64_t> total_duration{};
+
+    auto record(std::uint64_t duration) -> void {
+        constexpr auto relaxed = std::memory_order_relaxed;
+        count.store(count.load(relaxed) + 1, relaxed);
+        max_duration.store(std::max(max_duration.load(relaxed), duration),
+                           relaxed);
+        total_duration.store(total_duration.load(relaxed) + duration, relaxed);
+    }
+
+    [[nodiscard]] auto snapshot() const -> irq_stats {
+        constexpr auto relaxed = std::memory_order_relaxed;
+        return {count.load(relaxed), max_duration.load(relaxed),
+                total_duration.load(relaxed)};
+    }
+};
+
+template <typename Key> CONSTINIT inline irq_counters statistics{};
+
+template <typename Name, std::size_t NodeCapacity, std::size_t EdgeCapacity>
+auto flow_name(flow::builder<Name, NodeCapacity, EdgeCapacity> const *)
+    -> Name;
+} // namespace detail
+
+namespace null {
+struct instrumentation {
+    template <typename Key, typename F> static auto measure(F &&f) -> void {
+        std::forward<F>(f)();
+    }
+};
+} // namespace null
+
+/**
+ * Instrumentation that counts irqs and sub_irqs and times their interrupt
+ * service routines.
+ *
+ * @tparam TimestampHal
+ *      A type with a static now() function returning an unsigned integral
+ * timestamp. Differences between timestamps are computed in that type, so a
+ * free-running counter that wraps is fine.
+ */
+template <typename TimestampHal> struct timed_instrumentation {
+    template <typename Key, typename F> static auto measure(F &&f) -> void {
+        auto const start = TimestampHal::now();
+        std::forward<F>(f)();
+        auto const duration = static_cast<std::uint64_t>(
+            static_cast<decltype(start)>(TimestampHal::now() - start));
+        detail::statistics<Key>.record(duration);
+    }
+};
+
+/**
+ * The interrupt instrumentation in use. By default there is none, and it costs
+ * nothing. To enable it, specialize this variable:
+ *
+ *     template <>
+ *     inline auto interrupt::instrumentation<> =
+ *         interrupt::timed_instrumentation<my_timestamp_hal>{};
+ */
+template <typename...> inline auto instrumentation = null::instrumentation{};
+
+template <typename Key, typename... Ts, typename F>
+ALWAYS_INLINE auto measure(F &&f) -> void {
+    auto &i = instrumentation<Ts...>;
+    i.template measure<Key>(std::forward<F>(f));
+}
+
+/**
+ * @return A snapshot of the statistics for the top-level irq with the given
+ * number.
+ */
+template <std::size_t IrqNumber>
+[[nodiscard]] auto irq_statistics() -> irq_stats {
+    return detail::statistics<irq_key<IrqNumber>>.snapshot();
+}
+
+/**
+ * @return A snapshot of the statistics for the sub_irq whose interrupt service
+ * routines are attached to IrqCallback.
+ */
+template <typename IrqCallback>
+[[nodiscard]] auto sub_irq_statistics() -> irq_stats {
+    return detail::statistics<sub_irq_key<IrqCallback>>.snapshot();
+}
+
+/**
+ * Log the statistics of every irq and sub_irq in an interrupt configuration.
+ *
+ * @tparam RootT
+ *      The interrupt configuration, as given to interrupt::manager.
+ */
+template <typename RootT> auto log_statistics() -> void {
+    stdx::for_each(
+        []<typename Irq>(Irq) {
+            if constexpr (requires { Irq::irq_number; }) {
+                auto const s = irq_statistics<Irq::irq_number>();
+                CIB_INFO("IRQ {}: count={}, max={}, total={}",
+                         sc::uint_<Irq::irq_number>, s.count, s.max_duration,
+                         s.total_duration);
+            } else if constexpr (not std::is_void_v<
+                                     typename Irq::IrqCallbackType>) {
+                using callback_t = typename Irq::IrqCallbackType;
+                using name_t = decltype(detail::flow_name(
+                    std::declval<callback_t const *>()));
+                auto const s = sub_irq_statistics<callback_t>();
+                if constexpr (std::is_void_v<name_t>) {
+                    CIB_INFO("sub_irq: count={}, max={}, total={}", s.count,
+                             s.max_duration, s.total_duration);
+                } else {
+                    CIB_INFO("sub_irq {}: count={}, max={}, total={}",
+                             name_t{}, s.count, s.max_duration,
+                             s.total_duration);
+                }
+            }
+        },
+        RootT::all_irqs);
+}
+} // namespace interrupt
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <interrupt/deferred.hpp>
+#include <interrupt/fwd.hpp>
+
 #include <stdx/tuple.hpp>
 
+#include <type_traits>
 #include <utility>
 
 namespace interrupt {
@@ -38,6 +42,85 @@ struct dont_clear_status {
     }
 };
 
+/**
+ * Clear the status of every pending sub_irq in a status register with a single
+ * write, instead of one write per sub_irq.
+ *
+ * The pending bits are collected while the parent irq dispatches its sub_irqs,
+ * and written back either before any of them run (clear_status_first) or after
+ * all of them have run (clear_status_last). The status register must be
+ * write-1-to-clear, and the sub_irq's enable and status fields must be the same
+ * single bit in their registers.
+ *
+ * @tparam When
+ *      clear_status_first or clear_status_last.
+ */
+template <typename When = clear_status_first> struct clear_status_batched {
+    static_assert(std::is_same_v<When, clear_status_first> or
+                      std::is_same_v<When, clear_status_last>,
+                  "clear_status_batched must be used with clear_status_first "
+                  "or clear_status_last");
+
+    using PolicyType = status_clear_policy;
+    using order = When;
+
+    // the status is cleared by the parent irq, for all sub_irqs at once
+    template <typename ClearStatusCallable, typename RunCallable>
+    static void run(ClearStatusCallable const &, RunCallable const &run) {
+        run();
+    }
+};
+
+namespace detail {
+template <typename Policy> constexpr bool is_clear_status_batched = false;
+template <typename When>
+constexpr bool is_clear_status_batched<clear_status_batched<When>> = true;
+} // namespace detail
+
+struct dispatch_priority_policy {};
+
+/**
+ * The order in which the sub_irqs of a shared irq are checked and run.
+ *
+ * When several sub_irqs are pending, those with a higher priority are run
+ * first. sub_irqs with equal priority are run in the order of their status
+ * bits, or in declaration order if they are not dispatched by bit position.
+ * The default priority is 0.
+ *
+ * @tparam Priority
+ *      The dispatch priority; higher values run first.
+ */
+template <int Priority = 0> struct dispatch_priority {
+    using PolicyType = dispatch_priority_policy;
+
+    constexpr static int value = Priority;
+};
+
+struct execution_policy {};
+
+struct run_immediately {
+    using PolicyType = execution_policy;
+
+    static void run(FunctionPtr isr) { isr(); }
+};
+
+/**
+ * Run the interrupt service routines of an irq or sub_irq later, outside of
+ * interrupt context, by queueing them on interrupt::deferred_work. They run
+ * when the main loop or a worker calls interrupt::run_deferred().
+ *
+ * The interrupt status is still handled in interrupt context according to the
+ * status clear policy; the deferred routine must deal with the cause of the
+ * interrupt in the peripheral.
+ */
+struct deferred {
+    using PolicyType = execution_policy;
+
+    template <typename... Ts> static void run(FunctionPtr isr) {
+        defer<Ts...>(isr);
+    }
+};
+
 struct required_resources_policy {};
 
 template <typename... ResourcesT> struct required_resources {
@@ -2,7 +2,9 @@
 
 #include <log/level.hpp>
 
+#include <atomic>
 #include <cstdint>
+#include <span>
 
 namespace sc {
 template <typename...> struct args;
@@ -18,3 +20,18 @@ template <typename StringType> extern auto catalog() -> string_id;
 template <typename StringType> inline auto catalog(StringType) -> string_id {
     return catalog<StringType>();
 }
+
+using module_id = std::uint32_t;
+
+/**
+ * The runtime level of a module, as how far below TRACE it is, so that zero
+ * logs everything. The string catalog defines one for each module it finds.
+ */
+template <typename ModuleString>
+extern std::atomic<std::uint8_t> catalog_module_quietness;
+
+/**
+ * The runtime level of every module in the string catalog, indexed by
+ * module_id.
+ */
+extern std::span<std::atomic<std::uint8_t> *const> const catalog_module_levels;
@@ -5,12 +5,46 @@
 #include <log/log.hpp>
 
 #include <stdx/compiler.hpp>
+#include <stdx/ct_conversions.hpp>
 #include <stdx/tuple.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
 namespace {
+// arguments are cataloged as fixed-width types, so that the decoder can tell
+// how many bytes each one was packed into whatever the target's data model
+template <typename T> constexpr auto to_catalog_arg() {
+    if constexpr (std::is_enum_v<T>) {
+        return to_catalog_arg<std::underlying_type_t<T>>();
+    } else if constexpr (std::is_same_v<T, bool> or not std::is_integral_v<T>) {
+        return std::type_identity<T>{};
+    } else if constexpr (sizeof(T) == 1) {
+        return std::type_identity<std::conditional_t<std::is_signed_v<T>,
+                                                     signed char,
+                                                     unsigned char>>{};
+    } else if constexpr (sizeof(T) == 2) {
+        return std::type_identity<
+            std::conditional_t<std::is_signed_v<T>, short, unsigned short>>{};
+    } else if constexpr (sizeof(T) == 4) {
+        return std::type_identity<
+            std::conditional_t<std::is_signed_v<T>, int, unsigned int>>{};
+    } else {
+        return std::type_identity<std::conditional_t<
+            std::is_signed_v<T>, long long, unsigned long long>>{};
+    }
+}
+
+template <typename T>
+using catalog_arg_t = typename decltype(to_catalog_arg<T>())::type;
+
 template <logging::level L, typename S, typename T>
 constexpr auto to_message() {
     constexpr auto s = S::value;
@@ -18,7 +52,8 @@ constexpr auto to_message() {
     return [&]<template <typename...> typename Tuple, typename... Args,
                std::size_t... Is>(Tuple<Args...> const &,
                                   std::integer_sequence<std::size_t, Is...>) {
-        return message<L, sc::undefined<sc::args<Args...>, char_t, s[Is]...>>{};
+        return message<L, sc::undefined<sc::args<catalog_arg_t<Args>...>,
+                                         char_t, s[Is]...>>{};
     }(T{}, std::make_integer_sequence<std::size_t, std::size(s)>{});
 }
 
@@ -29,11 +64,208 @@ template <logging::level L, typename Msg> constexpr auto to_message(Msg msg) {
         return to_message<L, Msg, stdx::tuple<>>();
     }
 }
+
+template <typename Module> constexpr auto to_module() {
+    constexpr auto s = stdx::type_as_string<Module>();
+    return [&]<std::size_t... Is>(std::integer_sequence<std::size_t, Is...>) {
+        return std::type_identity<sc::undefined<sc::args<>, char, s[Is]...>>{};
+    }(std::make_integer_sequence<std::size_t, std::size(s)>{});
+}
 } // namespace
 
 namespace logging::mipi {
-template <typename TDestinations> struct log_handler {
-    constexpr explicit log_handler(TDestinations &&ds) : dests{std::move(ds)} {}
+namespace detail {
+// arguments are sent at their C-promoted width, as printf's variadic arguments
+// are: 64-bit integral values (and enums) take two 32-bit words, anything else
+// is sent as one 32-bit word
+template <typename T>
+constexpr std::size_t arg_words =
+    (std::is_integral_v<T> or std::is_enum_v<T>) and
+            sizeof(T) > sizeof(std::uint32_t)
+        ? 2u
+        : 1u;
+
+/**
+ * @return The argument extended to 64 bits: signed values are sign-extended,
+ * so that the low 32 bits are the argument promoted to a 32-bit word.
+ */
+template <typename T> constexpr auto to_arg_bits(T t) -> std::uint64_t {
+    if constexpr (std::is_enum_v<T>) {
+        return to_arg_bits(static_cast<std::underlying_type_t<T>>(t));
+    } else if constexpr (std::is_same_v<T, bool>) {
+        return t ? 1u : 0u;
+    } else if constexpr (std::is_integral_v<T>) {
+        return static_cast<std::uint64_t>(
+            static_cast<std::conditional_t<std::is_signed_v<T>, std::int64_t,
+                                           std::uint64_t>>(t));
+    } else {
+        return static_cast<std::uint32_t>(t);
+    }
+}
+
+/**
+ * Lay out arguments as 32-bit words: one word per argument, or two
+ * little-endian words (low word first) for a 64-bit argument.
+ */
+template <typename... Args>
+constexpr auto to_arg_words(Args... args)
+    -> std::array<std::uint32_t, (arg_words<Args> + ... + 0u)> {
+    auto words = std::array<std::uint32_t, (arg_words<Args> + ... + 0u)>{};
+    auto i = std::size_t{};
+    auto const put = [&]<typename T>(T t) {
+        auto const bits = to_arg_bits(t);
+        words[i++] = static_cast<std::uint32_t>(bits);
+        if constexpr (arg_words<T> == 2u) {
+            words[i++] = static_cast<std::uint32_t>(bits >> 32u);
+        }
+    };
+    (put(args), ...);
+    return words;
+}
+} // namespace detail
+
+/**
+ * A destination that is safe to call concurrently from any context declares
+ * `constexpr static bool lock_free = true;`, and is called without a critical
+ * section.
+ */
+template <typename Dest>
+concept lock_free_destination = requires {
+    requires Dest::lock_free;
+};
+
+// mipi sys-t header flag: the record carries a timestamp
+constexpr inline std::uint32_t timestamp_flag = 1u << 11u;
+
+// reserved in sys-t 1.0: the timestamp is a 32-bit delta, see delta_timestamps
+constexpr inline std::uint32_t delta_timestamp_flag = 1u << 7u;
+
+/**
+ * Records are not timestamped. Catalog messages without arguments are sent as
+ * short messages.
+ */
+struct no_timestamps {};
+
+/**
+ * Every record carries a 64-bit timestamp in the standard sys-t timestamp
+ * field.
+ *
+ * @tparam Clock
+ *      A callable returning the current time as an unsigned integer, ideally a
+ * raw cycle counter.
+ */
+template <typename Clock> struct full_timestamps {
+    Clock clock;
+
+    template <typename F> auto stamp(F &&f) -> void {
+        auto const t = static_cast<std::uint64_t>(clock());
+        std::forward<F>(f)(timestamp_flag, static_cast<std::uint32_t>(t),
+                           static_cast<std::uint32_t>(t >> 32u));
+    }
+};
+
+template <typename Clock> full_timestamps(Clock) -> full_timestamps<Clock>;
+
+/**
+ * Records carry a 32-bit timestamp: the time since the most recent sync point,
+ * which is a multiple of 2^32 clock ticks. The first record stamped after
+ * each sync point carries a full 64-bit timestamp instead, and records are
+ * only delta-stamped once a full timestamp from their sync period has been
+ * sent. Several producers may stamp records concurrently; records racing
+ * across a sync point all carry full timestamps, and may reach the decoder
+ * out of order. A decoder takes the time of a delta-stamped record to be the
+ * 64-bit value with those low 32 bits that is nearest to the most recent full
+ * timestamp.
+ *
+ * Delta-stamped records set the timestamp flag and bit 7 of the header, and
+ * their timestamp field is one word long. This is not part of sys-t 1.0: the
+ * host decoder must be configured for it.
+ *
+ * @tparam Clock
+ *      A callable returning the current time as an unsigned integer, ideally a
+ * raw cycle counter.
+ */
+template <typename Clock> struct delta_timestamps {
+    Clock clock;
+    // one more than the upper half of the last full timestamp sent; zero
+    // until one has been sent
+    std::uint32_t synced_epoch{};
+
+    template <typename F> auto stamp(F &&f) -> void {
+        auto const t = static_cast<std::uint64_t>(clock());
+        auto const hi = static_cast<std::uint32_t>(t >> 32u);
+        auto synced = std::atomic_ref{synced_epoch};
+        if (synced.load(std::memory_order_acquire) == hi + 1u) {
+            std::forward<F>(f)(timestamp_flag | delta_timestamp_flag,
+                               static_cast<std::uint32_t>(t));
+        } else {
+            std::forward<F>(f)(timestamp_flag, static_cast<std::uint32_t>(t),
+                               hi);
+            // only now may other records rely on this full timestamp
+            synced.store(hi + 1u, std::memory_order_release);
+        }
+    }
+};
+
+template <typename Clock> delta_timestamps(Clock) -> delta_timestamps<Clock>;
+
+template <typename T>
+concept timestamp_policy = requires(T &t) {
+    t.stamp([](std::uint32_t, auto...) {});
+};
+
+/**
+ * Records are not rate limited.
+ */
+struct no_rate_limit {};
+
+/**
+ * Each call site (catalog string) may log Burst records per period. Further
+ * records are dropped and counted, and a summary record for each call site
+ * that dropped any is logged when the period ends, at level WARN. A period is
+ * ended by calling log_handler::report_suppressed(), e.g. from a timer.
+ *
+ * The state for each call site is a counter and a link in static storage.
+ * Checking the limit costs one atomic increment, and the first record of a
+ * call site's period also checks that the call site is listed for the
+ * summary.
+ */
+template <std::uint32_t Burst> struct rate_limit {
+    constexpr static std::uint32_t burst = Burst;
+};
+
+template <typename T>
+concept rate_limit_policy = requires {
+    { T::burst } -> std::convertible_to<std::uint32_t>;
+};
+
+namespace detail {
+struct rate_limited_site {
+    std::atomic<std::uint32_t> count{};
+    std::atomic<bool> listed{};
+    string_id id{};
+    rate_limited_site *next{};
+};
+
+struct suppressed_summary_string {
+    constexpr static std::string_view value =
+        "{} records suppressed by rate limit at string ID {}";
+};
+} // namespace detail
+
+/**
+ * @tparam Timestamps
+ *      no_timestamps, or a timestamp_policy such as full_timestamps or
+ * delta_timestamps.
+ *
+ * @tparam RateLimit
+ *      no_rate_limit, or a rate_limit_policy such as rate_limit.
+ */
+template <typename TDestinations, typename Timestamps = no_timestamps,
+          typename RateLimit = no_rate_limit>
+struct log_handler {
+    constexpr explicit log_handler(TDestinations &&ds, Timestamps ts = {})
+        : dests{std::move(ds)}, timestamps{std::move(ts)} {}
 
     template <logging::level Level, typename FilenameStringType,
               typename LineNumberType, typename MsgType>
@@ -42,20 +274,132 @@ template <typename TDestinations> struct log_handler {
         log_msg<Level>(msg);
     }
 
+    template <logging::level Level, typename Module,
+              typename FilenameStringType, typename LineNumberType,
+              typename MsgType>
+    ALWAYS_INLINE auto log_module(FilenameStringType, LineNumberType,
+                                  MsgType const &msg) -> void {
+        using module_t = typename decltype(to_module<Module>())::type;
+        // the module's level lives at a link-time address: one load and
+        // one compare against a constant
+        if (catalog_module_quietness<module_t>.load(
+                std::memory_order_relaxed) <= logging::level::TRACE - Level) {
+            log_msg<Level>(msg);
+        }
+    }
+
+    /**
+     * Set the most verbose level logged at runtime by a module, as numbered
+     * in the string catalog. Unknown modules are ignored.
+     *
+     * Module levels are kept by the string catalog, so they are shared by
+     * every MIPI log handler in the program.
+     */
+    auto set_level(module_id id, logging::level level) -> void {
+        if (id < catalog_module_levels.size()) {
+            catalog_module_levels[id]->store(to_quietness(level),
+                                             std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Set the most verbose level logged at runtime by every module.
+     */
+    auto set_level(logging::level level) -> void {
+        for (auto *q : catalog_module_levels) {
+            q->store(to_quietness(level), std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] auto get_level(module_id id) const -> logging::level {
+        return static_cast<logging::level>(logging::level::TRACE -
+                                           quietness(id));
+    }
+
+    [[nodiscard]] auto is_enabled(logging::level level, module_id id) const
+        -> bool {
+        return quietness(id) <= logging::level::TRACE - level;
+    }
+
     ALWAYS_INLINE auto log_id(string_id id) -> void {
         dispatch_message<logging::level::TRACE>(id);
     }
 
     template <logging::level Level, typename Msg>
     ALWAYS_INLINE auto log_msg(Msg msg) -> void {
-        msg.apply([&]<typename StringType>(StringType, auto... args) {
+        msg.apply([&]<typename StringType, typename... Args>(StringType,
+                                                             Args... args) {
             using Message = decltype(to_message<Level>(msg));
-            dispatch_message<Level>(catalog<Message>(),
-                                    static_cast<std::uint32_t>(args)...);
+            if constexpr (rate_limit_policy<RateLimit>) {
+                if (not admit<Message>()) {
+                    return;
+                }
+            }
+            auto const words = detail::to_arg_words(args...);
+            [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                dispatch_message<Level>(catalog<Message>(), words[Is]...);
+            }(std::make_index_sequence<std::tuple_size_v<decltype(words)>>{});
         });
     }
 
+    /**
+     * End the current rate limit period: log a summary record for each call
+     * site that has dropped records since the last call, and let every call
+     * site log again. Must not be called concurrently with itself.
+     */
+    auto report_suppressed() -> void
+        requires rate_limit_policy<RateLimit>
+    {
+        using summary_t =
+            decltype(to_message<logging::level::WARN,
+                                detail::suppressed_summary_string,
+                                stdx::tuple<std::uint32_t, string_id>>());
+        // sites are only ever added to the front of the list, so this walk
+        // may run concurrently with logging
+        auto *site = rate_limited_sites.load(std::memory_order_acquire);
+        while (site != nullptr) {
+            auto const count =
+                site->count.exchange(0, std::memory_order_relaxed);
+            if (count > RateLimit::burst) {
+                dispatch_message<logging::level::WARN>(
+                    catalog<summary_t>(), count - RateLimit::burst, site->id);
+            }
+            site = site->next;
+        }
+    }
+
   private:
+    template <typename Message>
+    CONSTINIT static inline detail::rate_limited_site site_state{};
+
+    CONSTINIT static inline std::atomic<detail::rate_limited_site *>
+        rate_limited_sites{};
+
+    template <typename Message> auto admit() -> bool {
+        auto &site = site_state<Message>;
+        auto const count = site.count.fetch_add(1, std::memory_order_relaxed);
+        if (count == 0 and
+            not site.listed.exchange(true, std::memory_order_relaxed)) {
+            site.id = catalog<Message>();
+            site.next = rate_limited_sites.load(std::memory_order_relaxed);
+            while (not rate_limited_sites.compare_exchange_weak(
+                site.next, &site, std::memory_order_release,
+                std::memory_order_relaxed)) {
+            }
+        }
+        return count < RateLimit::burst;
+    }
+
+    static auto quietness(module_id id) -> std::uint8_t {
+        return id < catalog_module_levels.size()
+                   ? catalog_module_levels[id]->load(std::memory_order_relaxed)
+                   : std::uint8_t{};
+    }
+
+    constexpr static auto to_quietness(logging::level level) -> std::uint8_t {
+        return static_cast<std::uint8_t>(logging::level::TRACE - level);
+    }
+
     CONSTEVAL static auto make_catalog32_header(logging::level level)
         -> std::uint32_t {
         return (0x1u << 24u) | // mipi sys-t subtype: id32_p32
@@ -67,13 +411,22 @@ template <typename TDestinations> struct log_handler {
         return (id << 4u) | 1u;
     }
 
+    template <typename Dest, typename F>
+    ALWAYS_INLINE static auto call_destination(F &&f) -> void {
+        if constexpr (lock_free_destination<Dest>) {
+            std::forward<F>(f)();
+        } else {
+            conc::call_in_critical_section<Dest>(std::forward<F>(f));
+        }
+    }
+
     template <typename... MsgDataTypes>
     // NOLINTNEXTLINE(cppcoreguidelines-missing-std-forward)
     NEVER_INLINE auto dispatch_pass_by_args(MsgDataTypes &&...msg_data)
         -> void {
         stdx::for_each(
             [&]<typename Dest>(Dest &dest) {
-                conc::call_in_critical_section<Dest>([&] {
+                call_destination<Dest>([&] {
                     dest.log_by_args(std::forward<MsgDataTypes>(msg_data)...);
                 });
             },
@@ -84,36 +437,95 @@ template <typename TDestinations> struct log_handler {
                                               std::uint32_t msg_size) -> void {
         stdx::for_each(
             [&]<typename Dest>(Dest &dest) {
-                conc::call_in_critical_section<Dest>(
+                call_destination<Dest>(
                     [&] { dest.log_by_buf(msg, msg_size); });
             },
             dests);
     }
 
+    template <std::size_t PayloadSize, typename... Words>
+    ALWAYS_INLINE auto dispatch_words(Words... words) -> void {
+        if constexpr (PayloadSize <= 2u) {
+            dispatch_pass_by_args(words...);
+        } else {
+            std::array args = {static_cast<std::uint32_t>(words)...};
+            dispatch_pass_by_buffer(args.data(), args.size());
+        }
+    }
+
     template <logging::level Level, typename... MsgDataTypes>
     ALWAYS_INLINE auto dispatch_message(string_id id,
                                         MsgDataTypes &&...msg_data) -> void {
-        if constexpr (sizeof...(msg_data) == 0u) {
+        if constexpr (timestamp_policy<Timestamps>) {
+            // a short message has no timestamp field
+            timestamps.stamp([&](std::uint32_t flags, auto... ts) {
+                dispatch_words<sizeof...(msg_data)>(
+                    make_catalog32_header(Level) | flags, ts..., id,
+                    std::forward<MsgDataTypes>(msg_data)...);
+            });
+        } else if constexpr (sizeof...(msg_data) == 0u) {
             dispatch_pass_by_args(make_short32_header(id));
-        } else if constexpr (sizeof...(msg_data) <= 2u) {
-            dispatch_pass_by_args(make_catalog32_header(Level), id,
-                                  std::forward<MsgDataTypes>(msg_data)...);
         } else {
-            std::array args = {make_catalog32_header(Level), id,
-                               std::forward<MsgDataTypes>(msg_data)...};
-            dispatch_pass_by_buffer(args.data(), args.size());
+            dispatch_words<sizeof...(msg_data)>(
+                make_catalog32_header(Level), id,
+                std::forward<MsgDataTypes>(msg_data)...);
         }
     }
 
     TDestinations dests;
+    [[no_unique_address]] Timestamps timestamps;
 };
 
-template <typename... TDestinations> struct config {
+namespace detail {
+template <typename Timestamps, typename RateLimit, typename... TDestinations>
+struct config_base {
     using destinations_tuple_t = stdx::tuple<TDestinations...>;
+    constexpr explicit config_base(Timestamps ts, TDestinations... dests)
+        : logger{stdx::tuple{std::move(dests)...}, std::move(ts)} {}
+
+    log_handler<destinations_tuple_t, Timestamps, RateLimit> logger;
+};
+} // namespace detail
+
+template <typename... TDestinations>
+struct config
+    : detail::config_base<no_timestamps, no_rate_limit, TDestinations...> {
     constexpr explicit config(TDestinations... dests)
-        : logger{stdx::tuple{std::move(dests)...}} {}
+        : detail::config_base<no_timestamps, no_rate_limit, TDestinations...>{
+              {}, std::move(dests)...} {}
+};
 
-    log_handler<destinations_tuple_t> logger;
+/**
+ * A config may start with a timestamp policy, a rate limit policy, or both:
+ *
+ *     logging::mipi::config{logging::mipi::full_timestamps{read_cycles},
+ *                           logging::mipi::rate_limit<4>{}, dest}
+ */
+template <timestamp_policy Timestamps, typename... TDestinations>
+struct config<Timestamps, TDestinations...>
+    : detail::config_base<Timestamps, no_rate_limit, TDestinations...> {
+    constexpr explicit config(Timestamps ts, TDestinations... dests)
+        : detail::config_base<Timestamps, no_rate_limit, TDestinations...>{
+              std::move(ts), std::move(dests)...} {}
 };
+
+template <rate_limit_policy RateLimit, typename... TDestinations>
+struct config<RateLimit, TDestinations...>
+    : detail::config_base<no_timestamps, RateLimit, TDestinations...> {
+    constexpr explicit config(RateLimit, TDestinations... dests)
+        : detail::config_base<no_timestamps, RateLimit, TDestinations...>{
+              {}, std::move(dests)...} {}
+};
+
+template <timestamp_policy Timestamps, rate_limit_policy RateLimit,
+          typename... TDestinations>
+struct config<Timestamps, RateLimit, TDestinations...>
+    : detail::config_base<Timestamps, RateLimit, TDestinations...> {
+    constexpr explicit config(Timestamps ts, RateLimit,
+                              TDestinations... dests)
+        : detail::config_base<Timestamps, RateLimit, TDestinations...>{
+              std::move(ts), std::move(dests)...} {}
+};
+
 template <typename... Ts> config(Ts...) -> config<Ts...>;
 } // namespace logging::mipi
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+
+namespace logging::mipi {
+struct single_ring {
+    [[nodiscard]] static auto index() -> std::size_t { return 0; }
+};
+
+/**
+ * Lock-free storage for MIPI SyS-T frames, written by log statements and
+ * drained elsewhere.
+ *
+ * Each ring accepts frames from any number of producers (e.g. threads and
+ * interrupts at several priorities) and is drained by a single consumer. A
+ * producer reserves space by advancing the ring's head with a compare-exchange,
+ * copies its frame, and commits it by storing the frame's length word. The
+ * consumer streams committed frames to a transport in order and stops at the
+ * first one still being written.
+ *
+ * Frames are never split across the end of a ring: if a frame does not fit
+ * before the end, the rest of the ring is reserved as padding.
+ *
+ * @tparam Capacity
+ *      The size of each ring in 32-bit words. Must be a power of two.
+ *
+ * @tparam Rings
+ *      The number of rings, e.g. one per core, or one per interrupt priority.
+ *
+ * @tparam RingIndex
+ *      A type with a static index() function that returns the ring a producer
+ * should use, in [0, Rings).
+ */
+template <std::size_t Capacity, std::size_t Rings = 1,
+          typename RingIndex = single_ring>
+class log_rings {
+    static_assert(std::has_single_bit(Capacity),
+                  "log_rings capacity must be a power of two");
+
+    // each frame is preceded by a word holding its length, or the length of
+    // padding with the padding bit set; zero means not yet committed
+    constexpr static std::uint32_t padding_bit = 0x8000'0000u;
+
+    struct ring {
+        std::array<std::uint32_t, Capacity> words{};
+        std::atomic<std::size_t> head{};
+        std::atomic<std::size_t> tail{};
+        std::atomic<std::uint32_t> dropped{};
+    };
+
+    std::array<ring, Rings> rings{};
+
+    static auto commit(ring &r, std::size_t index, std::uint32_t length)
+        -> void {
+        std::atomic_ref{r.words[index]}.store(length,
+                                              std::memory_order_release);
+    }
+
+    template <typename F>
+    static auto write(ring &r, std::size_t size, F &&copy_frame) -> bool {
+        auto const needed = size + 1;
+        auto h = r.head.load(std::memory_order_relaxed);
+        auto pad = std::size_t{};
+        do {
+            auto const offset = h % Capacity;
+            pad = offset + needed > Capacity ? Capacity - offset : 0;
+            if (h + pad + needed - r.tail.load(std::memory_order_acquire) >
+                Capacity) {
+                r.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (not r.head.compare_exchange_weak(h, h + pad + needed,
+                                                  std::memory_order_relaxed));
+
+        if (pad != 0) {
+            commit(r, h % Capacity,
+                   padding_bit | static_cast<std::uint32_t>(pad - 1));
+            h += pad;
+        }
+        auto const offset = h % Capacity;
+        copy_frame(std::next(r.words.data(),
+                             static_cast<std::ptrdiff_t>(offset + 1)));
+        commit(r, offset, static_cast<std::uint32_t>(size));
+        return true;
+    }
+
+  public:
+    /**
+     * Write one frame to the calling producer's ring.
+     *
+     * @return false if the ring was full and the frame was dropped.
+     */
+    template <typename... Words> auto log_by_args(Words... ws) -> bool {
+        static_assert(sizeof...(Words) != 0,
+                      "log_rings frames cannot be empty");
+        static_assert(sizeof...(Words) + 1 <= Capacity,
+                      "log_rings capacity is too small for this frame");
+        return write(rings[RingIndex::index()], sizeof...(Words),
+                     [&](std::uint32_t *dst) {
+                         ((*dst++ = static_cast<std::uint32_t>(ws)), ...);
+                     });
+    }
+
+    /**
+     * Write one frame to the calling producer's ring. An empty frame is
+     * ignored: its length word would read as not yet committed.
+     *
+     * @return false if the frame was empty, or if the ring was full or the
+     * frame too large, and the frame was dropped.
+     */
+    auto log_by_buf(std::uint32_t const *msg, std::uint32_t msg_size) -> bool {
+        if (msg_size == 0) {
+            return false;
+        }
+        auto &r = rings[RingIndex::index()];
+        if (msg_size + 1u > Capacity) {
+            r.dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return write(r, msg_size, [&](std::uint32_t *dst) {
+            std::copy_n(msg, msg_size, dst);
+        });
+    }
+
+    /**
+     * Stream the committed frames of every ring to a transport. Must not be
+     * called concurrently with itself.
+     *
+     * @param transport
+     *      Called with a std::span<std::uint32_t const> for each frame, in the
+     * order the frames were reserved in each ring.
+     *
+     * @return The number of frames streamed.
+     */
+    template <typename Transport>
+    auto drain(Transport &&transport) -> std::size_t {
+        auto frames = std::size_t{};
+        for (auto &r : rings) {
+            auto t = r.tail.load(std::memory_order_relaxed);
+            auto const h = r.head.load(std::memory_order_acquire);
+            while (t != h) {
+                auto const offset = t % Capacity;
+                auto const length = std::atomic_ref{r.words[offset]}.load(
+                    std::memory_order_acquire);
+                if (length == 0) {
+                    break; // reserved, but still being written
+                }
+                auto const size = length & ~padding_bit;
+                if ((length & padding_bit) == 0) {
+                    transport(std::span<std::uint32_t const>{
+                        std::next(r.words.data(),
+                                  static_cast<std::ptrdiff_t>(offset + 1)),
+                        size});
+                    ++frames;
+                }
+                // a stale length word would look like a committed frame later
+                std::fill_n(std::next(r.words.data(),
+                                      static_cast<std::ptrdiff_t>(offset)),
+                            size + 1, std::uint32_t{});
+                t += size + 1;
+                r.tail.store(t, std::memory_order_release);
+            }
+        }
+        return frames;
+    }
+
+    /**
+     * @return The number of frames dropped because a ring was full.
+     */
+    [[nodiscard]] auto dropped_count() const -> std::uint32_t {
+        auto n = std::uint32_t{};
+        for (auto const &r : rings) {
+            n += r.dropped.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+};
+
+/**
+ * A MIPI log destination that writes frames to log_rings. The log_handler
+ * calls it without a critical section.
+ */
+template <typename Rings> struct ring_buffer_destination {
+    constexpr static bool lock_free = true;
+
+    constexpr explicit ring_buffer_destination(Rings &rs) : rings{&rs} {}
+
+    template <typename... Words> auto log_by_args(Words... ws) -> void {
+        rings->log_by_args(ws...);
+    }
+
+    auto log_by_buf(std::uint32_t const *msg, std::uint32_t msg_size) -> void {
+        rings->log_by_buf(msg, msg_size);
+    }
+
+  private:
+    Rings *rings;
+};
+
+template <typename Rings>
+ring_buffer_destination(Rings &) -> ring_buffer_destination<Rings>;
+} // namespace logging::mipi
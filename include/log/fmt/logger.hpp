@@ -1,13 +1,30 @@
 #pragma once
 
+#include <conc/concurrency.hpp>
 #include <log/log.hpp>
 
+#include <stdx/compiler.hpp>
 #include <stdx/tuple.hpp>
 #include <stdx/tuple_algorithms.hpp>
 
+#include <fmt/compile.h>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stop_token>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 template <auto L> struct fmt::formatter<logging::level_constant<L>> {
@@ -22,32 +39,513 @@ template <auto L> struct fmt::formatter<logging::level_constant<L>> {
 };
 
 namespace logging::fmt {
-template <typename TDestinations> struct log_handler {
+/**
+ * Records are formatted straight into each destination.
+ */
+struct unbuffered {};
+
+/**
+ * Records are formatted once, with the format string compiled, into a
+ * thread-local buffer, and written to each destination in one piece. A
+ * destination is an output iterator, or a callable taking a std::string_view.
+ * Writes are made in a critical section, so records from different threads do
+ * not interleave.
+ *
+ * @tparam Size
+ *      The size of each thread's buffer in chars. Longer records are
+ * truncated.
+ *
+ * @tparam Batched
+ *      Whether records accumulate in the buffer, to be written when it is full,
+ * when log_handler::flush() is called on the thread, or when the thread exits.
+ * Otherwise each record is written as soon as it is formatted. A batching
+ * log_handler flushes the destroying thread's buffer when it is destroyed;
+ * every other thread that logged through it must call flush() first.
+ */
+template <std::size_t Size, bool Batched = false> struct buffered {
+    constexpr static std::size_t size = Size;
+    constexpr static bool batched = Batched;
+};
+
+template <typename T>
+concept buffering_policy = requires {
+    { T::size } -> std::convertible_to<std::size_t>;
+    { T::batched } -> std::convertible_to<bool>;
+};
+
+/**
+ * Records are not formatted by the thread that logs them. Instead the thread
+ * copies the message's arguments, with a pointer to a function that formats
+ * that message, into its own lock-free queue. Records are formatted and
+ * written later by log_handler::drain(), usually on a background thread
+ * started with log_handler::start_worker().
+ *
+ * Only arithmetic and enum arguments can be deferred.
+ *
+ * A thread's queue is allocated by its first deferred log call, unless the
+ * thread claims one up front with log_handler::prepare_thread(). Threads'
+ * queues are shared by every log_handler of the same type, so a program must
+ * have at most one deferred log_handler of each type (as logging::config<>
+ * does). A deferred log_handler drains the queues when it is destroyed, so
+ * its worker must be stopped first.
+ *
+ * @tparam QueueSize
+ *      The size of each thread's queue in bytes. Must be a power of two. When
+ * a queue is full, records are dropped and counted.
+ */
+template <std::size_t QueueSize> struct deferred {
+    constexpr static std::size_t queue_size = QueueSize;
+};
+
+template <typename T>
+concept deferral_policy = requires {
+    { T::queue_size } -> std::convertible_to<std::size_t>;
+};
+
+namespace detail {
+template <typename StringType> constexpr auto compiled_format() {
+    // FMT_COMPILE names fmt::, which would otherwise find logging::fmt
+    namespace fmt = ::fmt;
+    return FMT_COMPILE(StringType::value);
+}
+
+struct record_prefix {
+    constexpr static std::string_view value = "{:>8}us {}: ";
+};
+
+template <typename T>
+concept deferrable = std::is_arithmetic_v<T> or std::is_enum_v<T>;
+
+/**
+ * A single-producer, single-consumer ring of deferred records. Each record is
+ * a header (the function that formats it, and the record's size) followed by
+ * its payload, and is never split across the end of the ring.
+ */
+template <typename Handler, typename Deferral> struct deferred_queue {
+    constexpr static auto capacity = Deferral::queue_size;
+    static_assert(std::has_single_bit(capacity),
+                  "deferred queue size must be a power of two");
+
+    using decoder_t = auto (*)(Handler &, std::byte const *) -> void;
+
+    // a header with no decoder marks padding up to the end of the ring
+    struct header {
+        decoder_t decode;
+        std::size_t size;
+    };
+
+    constexpr static auto record_size(std::size_t payload_size)
+        -> std::size_t {
+        constexpr auto align = sizeof(header);
+        return (sizeof(header) + payload_size + align - 1) / align * align;
+    }
+
+    // the consumer's and the producer's indices are on separate cache lines
+    // so that neither invalidates the other's line on every record
+    constexpr static std::size_t cache_line_size = 64;
+
+    std::array<std::byte, capacity> bytes{};
+    alignas(cache_line_size) std::atomic<std::size_t> head{};
+    alignas(cache_line_size) std::atomic<std::size_t> tail{};
+    std::atomic<std::uint32_t> dropped{};
+    alignas(cache_line_size) std::atomic<bool> in_use{};
+    deferred_queue *next{};
+
+    template <std::size_t PayloadSize, typename F>
+    auto push(decoder_t decode, F &&write_payload) -> bool {
+        constexpr auto size = record_size(PayloadSize);
+        static_assert(size <= capacity,
+                      "deferred queue size is too small for this record");
+
+        auto t = tail.load(std::memory_order_relaxed);
+        auto const offset = t % capacity;
+        auto const pad = offset + size > capacity ? capacity - offset : 0;
+        if (t + pad + size - head.load(std::memory_order_acquire) > capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (pad != 0) {
+            write_header(offset, header{nullptr, pad});
+            t += pad;
+        }
+        write_header(t % capacity, header{decode, size});
+        std::forward<F>(write_payload)(at(t % capacity + sizeof(header)));
+        tail.store(t + size, std::memory_order_release);
+        return true;
+    }
+
+    template <typename F> auto pop_all(F &&f) -> std::size_t {
+        auto records = std::size_t{};
+        auto h = head.load(std::memory_order_relaxed);
+        auto const t = tail.load(std::memory_order_acquire);
+        while (h != t) {
+            auto const hdr = read_header(h % capacity);
+            if (hdr.decode != nullptr) {
+                f(hdr.decode, at(h % capacity + sizeof(header)));
+                ++records;
+            }
+            h += hdr.size;
+            head.store(h, std::memory_order_release);
+        }
+        return records;
+    }
+
+  private:
+    auto at(std::size_t offset) -> std::byte * {
+        return std::next(bytes.data(), static_cast<std::ptrdiff_t>(offset));
+    }
+
+    auto write_header(std::size_t offset, header hdr) -> void {
+        std::memcpy(at(offset), &hdr, sizeof(hdr));
+    }
+
+    auto read_header(std::size_t offset) -> header {
+        auto hdr = header{};
+        std::memcpy(&hdr, at(offset), sizeof(hdr));
+        return hdr;
+    }
+};
+
+template <typename Dest>
+auto write_to(Dest &dest, std::string_view record) -> void {
+    if constexpr (std::invocable<Dest &, std::string_view>) {
+        dest(record);
+    } else {
+        dest = std::copy(std::begin(record), std::end(record), dest);
+    }
+}
+} // namespace detail
+
+template <typename TDestinations, typename Mode = unbuffered>
+struct log_handler {
     constexpr explicit log_handler(TDestinations &&ds) : dests{std::move(ds)} {}
 
+    // a buffered or deferred handler is tied to per-thread state, so it can
+    // be neither copied nor moved, and it writes what it holds when it is
+    // destroyed
+    constexpr static bool has_thread_state =
+        buffering_policy<Mode> or deferral_policy<Mode>;
+
+    log_handler(log_handler const &)
+        requires(not has_thread_state)
+    = default;
+    log_handler(log_handler &&)
+        requires(not has_thread_state)
+    = default;
+    auto operator=(log_handler const &) -> log_handler &
+        requires(not has_thread_state)
+    = default;
+    auto operator=(log_handler &&) -> log_handler &
+        requires(not has_thread_state)
+    = default;
+
+    ~log_handler()
+        requires buffering_policy<Mode>
+    {
+        flush();
+    }
+    ~log_handler()
+        requires deferral_policy<Mode>
+    {
+        static_cast<void>(drain());
+    }
+    ~log_handler() = default;
+
     template <logging::level L, typename FilenameStringType,
               typename LineNumberType, typename MsgType>
     auto log(FilenameStringType, LineNumberType, MsgType const &msg) -> void {
-        auto const currentTime =
-            std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now() - start_time)
-                .count();
-
-        stdx::for_each(
-            [&](auto &out) {
-                ::fmt::format_to(out, "{:>8}us {}: ", currentTime,
-                                 level_constant<L>{});
-                msg.apply(
-                    [&]<typename StringType>(StringType, auto const &...args) {
+        if constexpr (deferral_policy<Mode>) {
+            log_deferred<L>(msg);
+        } else if constexpr (buffering_policy<Mode>) {
+            log_buffered<L>(msg);
+        } else {
+            auto const currentTime =
+                since_start(std::chrono::steady_clock::now());
+            stdx::for_each(
+                [&](auto &out) {
+                    ::fmt::format_to(out, "{:>8}us {}: ", currentTime,
+                                     level_constant<L>{});
+                    msg.apply([&]<typename StringType>(
+                                  StringType, auto const &...args) {
                         ::fmt::format_to(out, StringType::value, args...);
                     });
-                *out = '\n';
-            },
-            dests);
+                    *out = '\n';
+                },
+                dests);
+        }
+    }
+
+    /**
+     * Format and write the records deferred by every thread so far. Must not
+     * be called concurrently with itself.
+     *
+     * @return The number of records written.
+     */
+    auto drain() -> std::size_t
+        requires deferral_policy<Mode>
+    {
+        auto records = std::size_t{};
+        for (auto *q = deferred_queues.load(std::memory_order_acquire);
+             q != nullptr; q = q->next) {
+            records += q->pop_all(
+                [&](auto decode, std::byte const *payload) {
+                    decode(*this, payload);
+                });
+        }
+        return records;
+    }
+
+    /**
+     * Claim the calling thread's deferred queue, so that its first log call
+     * does not allocate one. Call it when a thread starts.
+     */
+    auto prepare_thread() -> void
+        requires deferral_policy<Mode>
+    {
+        static_cast<void>(local_queue());
+    }
+
+    /**
+     * Start a thread that drains deferred records, sleeping for the given
+     * period whenever there are none. Destroying the returned thread stops it
+     * after a last drain.
+     */
+    [[nodiscard]] auto start_worker(std::chrono::microseconds period =
+                                        std::chrono::milliseconds{1})
+        -> std::jthread
+        requires deferral_policy<Mode>
+    {
+        return std::jthread{[this, period](std::stop_token const &stop) {
+            while (not stop.stop_requested()) {
+                if (drain() == 0) {
+                    std::this_thread::sleep_for(period);
+                }
+            }
+            drain();
+        }};
+    }
+
+    /**
+     * @return The number of deferred records dropped because a thread's
+     * queue was full.
+     */
+    [[nodiscard]] auto dropped_count() const -> std::uint32_t
+        requires deferral_policy<Mode>
+    {
+        auto n = std::uint32_t{};
+        for (auto *q = deferred_queues.load(std::memory_order_acquire);
+             q != nullptr; q = q->next) {
+            n += q->dropped.load(std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    /**
+     * Write the records batched on the calling thread, and detach its buffer
+     * from the handler that batched them.
+     */
+    auto flush() -> void
+        requires buffering_policy<Mode>
+    {
+        auto &buf = local_buffer();
+        if (buf.owner != nullptr) {
+            buf.owner->write_buffer(buf);
+            buf.owner = nullptr;
+        }
     }
 
   private:
+    struct thread_buffer {
+        std::array<char, Mode::size> chars{};
+        std::size_t used{};
+        log_handler *owner{};
+
+        thread_buffer() = default;
+        thread_buffer(thread_buffer const &) = delete;
+        auto operator=(thread_buffer const &) -> thread_buffer & = delete;
+
+        ~thread_buffer() {
+            if (owner != nullptr) {
+                owner->write_buffer(*this);
+            }
+        }
+    };
+
+    static auto local_buffer() -> thread_buffer & {
+        thread_local thread_buffer buf{};
+        return buf;
+    }
+
+    // returns the size of the whole record, which may be more than n
+    template <logging::level L, typename MsgType>
+    static auto format_record(char *first, std::size_t n,
+                              std::int64_t currentTime, MsgType const &msg)
+        -> std::size_t {
+        auto size =
+            ::fmt::format_to_n(first, n,
+                               detail::compiled_format<detail::record_prefix>(),
+                               currentTime, to_text(L))
+                .size;
+        msg.apply([&]<typename StringType>(StringType, auto const &...args) {
+            auto const offset = std::min(size, n);
+            size += ::fmt::format_to_n(first + offset, n - offset,
+                                       detail::compiled_format<StringType>(),
+                                       args...)
+                        .size;
+        });
+        if (size < n) {
+            first[size] = '\n';
+        } else if (n != 0) {
+            first[n - 1] = '\n';
+        }
+        return size + 1;
+    }
+
+    template <logging::level L, typename MsgType>
+    auto log_buffered(MsgType const &msg) -> void {
+        auto &buf = local_buffer();
+        if (buf.owner != this) {
+            if (buf.owner != nullptr) {
+                buf.owner->write_buffer(buf);
+            }
+            buf.owner = this;
+        }
+
+        // the clock is read once per record, as it is formatted
+        auto const currentTime = since_start(std::chrono::steady_clock::now());
+
+        auto free = Mode::size - buf.used;
+        auto size = format_record<L>(buf.chars.data() + buf.used, free,
+                                     currentTime, msg);
+        if (size > free and buf.used != 0) {
+            // this record doesn't fit after the ones already batched
+            write_buffer(buf);
+            free = Mode::size;
+            size = format_record<L>(buf.chars.data(), free, currentTime, msg);
+        }
+        buf.used += std::min(size, free);
+
+        if constexpr (not Mode::batched) {
+            write_buffer(buf);
+        }
+    }
+
+    auto write_buffer(thread_buffer &buf) -> void {
+        if (buf.used == 0) {
+            return;
+        }
+        auto const records = std::string_view{buf.chars.data(), buf.used};
+        conc::call_in_critical_section<log_handler>([&] {
+            stdx::for_each(
+                [&](auto &dest) { detail::write_to(dest, records); }, dests);
+        });
+        buf.used = 0;
+    }
+
+    static auto since_start(std::chrono::steady_clock::time_point t)
+        -> std::int64_t {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   t - start_time)
+            .count();
+    }
+
+    using queue_t = detail::deferred_queue<log_handler, Mode>;
+
+    // queues are never freed: a thread that exits releases its queue for the
+    // next thread that starts logging. The list is per type, not per
+    // instance, which is why a type may have only one deferred log_handler.
+    struct queue_holder {
+        queue_t *queue{claim_queue()};
+
+        queue_holder() = default;
+        queue_holder(queue_holder const &) = delete;
+        auto operator=(queue_holder const &) -> queue_holder & = delete;
+
+        ~queue_holder() {
+            queue->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    static auto claim_queue() -> queue_t * {
+        for (auto *q = deferred_queues.load(std::memory_order_acquire);
+             q != nullptr; q = q->next) {
+            auto expected = false;
+            if (q->in_use.compare_exchange_strong(expected, true,
+                                                  std::memory_order_acquire)) {
+                return q;
+            }
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory)
+        auto *q = new queue_t{};
+        q->in_use.store(true, std::memory_order_relaxed);
+        q->next = deferred_queues.load(std::memory_order_relaxed);
+        while (not deferred_queues.compare_exchange_weak(
+            q->next, q, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        return q;
+    }
+
+    static auto local_queue() -> queue_t & {
+        thread_local queue_holder holder{};
+        return *holder.queue;
+    }
+
+    template <logging::level L, typename MsgType>
+    auto log_deferred(MsgType const &msg) -> void {
+        auto const t = std::chrono::steady_clock::now();
+        msg.apply([&]<typename StringType>(StringType, auto const &...args) {
+            static_assert(
+                (... and detail::deferrable<
+                             std::remove_cvref_t<decltype(args)>>),
+                "Deferred log arguments are copied and formatted later: "
+                "only arithmetic and enum arguments can be deferred");
+            constexpr auto payload_size = sizeof(t) + (sizeof(args) + ... + 0);
+            local_queue().template push<payload_size>(
+                &decode_deferred<L, StringType,
+                                 std::remove_cvref_t<decltype(args)>...>,
+                [&](std::byte *payload) {
+                    std::memcpy(payload, &t, sizeof(t));
+                    payload += sizeof(t);
+                    ((std::memcpy(payload, &args, sizeof(args)),
+                      payload += sizeof(args)),
+                     ...);
+                });
+        });
+    }
+
+    template <logging::level L, typename StringType, typename... Args>
+    static auto decode_deferred(log_handler &handler,
+                                std::byte const *payload) -> void {
+        auto t = std::chrono::steady_clock::time_point{};
+        std::memcpy(&t, payload, sizeof(t));
+        payload += sizeof(t);
+        auto args = std::tuple<Args...>{};
+        std::apply(
+            [&](auto &...as) {
+                ((std::memcpy(&as, payload, sizeof(as)), payload += sizeof(as)),
+                 ...);
+            },
+            args);
+
+        auto record = ::fmt::memory_buffer{};
+        auto out = std::back_inserter(record);
+        ::fmt::format_to(out, detail::compiled_format<detail::record_prefix>(),
+                         since_start(t), to_text(L));
+        std::apply(
+            [&](auto const &...as) {
+                ::fmt::format_to(out, detail::compiled_format<StringType>(),
+                                 as...);
+            },
+            args);
+        record.push_back('\n');
+
+        auto const text = std::string_view{record.data(), record.size()};
+        stdx::for_each([&](auto &dest) { detail::write_to(dest, text); },
+                       handler.dests);
+    }
+
     static inline auto const start_time = std::chrono::steady_clock::now();
+    CONSTINIT static inline std::atomic<queue_t *> deferred_queues{};
     TDestinations dests;
 };
 
@@ -58,4 +556,21 @@ template <typename... TDestinations> struct config {
 
     log_handler<destinations_tuple_t> logger;
 };
+
+/**
+ * A config whose first argument is a buffering or deferral policy:
+ *
+ *     logging::fmt::config{logging::fmt::buffered<256>{}, dest}
+ */
+template <typename Mode, typename... TDestinations>
+    requires buffering_policy<Mode> or deferral_policy<Mode>
+struct config<Mode, TDestinations...> {
+    using destinations_tuple_t = stdx::tuple<TDestinations...>;
+    constexpr explicit config(Mode, TDestinations... dests)
+        : logger{stdx::tuple{std::move(dests)...}} {}
+
+    log_handler<destinations_tuple_t, Mode> logger;
+};
+
+template <typename... Ts> config(Ts...) -> config<Ts...>;
 } // namespace logging::fmt
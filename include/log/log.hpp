@@ -20,6 +20,38 @@ struct config {
 
 template <typename...> inline auto config = null::config{};
 
+/**
+ * The default log module. To put the log statements in a function, class or
+ * namespace, or in the whole translation unit, in another module, declare
+ * there:
+ *
+ *     using cib_log_module = my_module;
+ *
+ * where my_module is any type.
+ */
+struct default_module {};
+
+/**
+ * The most verbose level that is compiled in. Log statements at more verbose
+ * levels are removed at compile time: their arguments are not evaluated and
+ * their strings are not emitted. By default, everything is compiled in. To
+ * change this, specialize this variable:
+ *
+ *     template <>
+ *     constexpr auto logging::level_threshold<> = logging::level::WARN;
+ */
+template <typename...> constexpr auto level_threshold = level::TRACE;
+
+/**
+ * The level threshold for a module, which defaults to level_threshold. It can
+ * be specialized to make a module more or less verbose.
+ */
+template <typename Module, typename... Ts>
+constexpr auto module_level_threshold = level_threshold<Ts...>;
+
+template <level L, typename Module, typename... Ts>
+constexpr bool is_enabled = L <= module_level_threshold<Module, Ts...>;
+
 template <typename T>
 concept loggable = requires(T const &t) {
     t.apply([]<typename StringType>(StringType, auto const &...) {});
@@ -30,11 +62,56 @@ static auto log(TArgs &&...args) -> void {
     auto &cfg = config<Ts...>;
     cfg.logger.template log<L>(std::forward<TArgs>(args)...);
 }
+
+/**
+ * Log a statement of a module. Loggers that filter by module implement
+ * log_module<L, Module>; other loggers are called with log<L>. A statement at
+ * a level that is not enabled for the module is not passed to the logger, so
+ * its string is not emitted.
+ */
+template <level L, typename Module, typename... Ts, typename... TArgs>
+static auto log_module(TArgs &&...args) -> void {
+    if constexpr (is_enabled<L, Module, Ts...>) {
+        auto &cfg = config<Ts...>;
+        if constexpr (requires {
+                          cfg.logger.template log_module<L, Module>(
+                              std::forward<TArgs>(args)...);
+                      }) {
+            cfg.logger.template log_module<L, Module>(
+                std::forward<TArgs>(args)...);
+        } else {
+            cfg.logger.template log<L>(std::forward<TArgs>(args)...);
+        }
+    }
+}
+
+namespace detail {
+/**
+ * A log statement names its module as
+ * decltype(cib_log_module(module_lookup{})). Where a cib_log_module type is in
+ * scope, that is a conversion to it; otherwise argument-dependent lookup finds
+ * the function below. So a cib_log_module declared in any scope, including the
+ * global one, is never ambiguous with the default.
+ */
+struct module_lookup {
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    template <typename T> operator T() const;
+};
+
+auto cib_log_module(module_lookup) -> default_module;
+} // namespace detail
 } // namespace logging
 
+#define CIB_LOG_MODULE_T                                                       \
+    decltype(cib_log_module(logging::detail::module_lookup{}))
+
+// the arguments are evaluated only if the level is enabled
 #define CIB_LOG(LEVEL, MSG, ...)                                               \
-    logging::log<LEVEL>(__FILE__, __LINE__,                                    \
-                        sc::formatter{MSG##_sc}(__VA_ARGS__))
+    static_cast<void>(                                                         \
+        logging::is_enabled<LEVEL, CIB_LOG_MODULE_T> and                       \
+        (logging::log_module<LEVEL, CIB_LOG_MODULE_T>(                         \
+             __FILE__, __LINE__, sc::formatter{MSG##_sc}(__VA_ARGS__)),        \
+         true))
 
 #define CIB_TRACE(...) CIB_LOG(logging::level::TRACE, __VA_ARGS__)
 #define CIB_INFO(...) CIB_LOG(logging::level::INFO, __VA_ARGS__)
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <conc/concurrency.hpp>
+#include <log/log.hpp>
+#include <seq/step.hpp>
+
+#include <stdx/compiler.hpp>
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+namespace seq {
+namespace detail {
+struct frame_storage {
+    void *data{};
+    std::size_t size{};
+};
+
+// The arena to be used by the next coroutine frame allocation. This is set by
+// the step that starts a coroutine, immediately before it is called.
+CONSTINIT inline frame_storage next_frame{};
+} // namespace detail
+
+class event;
+
+/**
+ * The return type of a coroutine that implements a seq step.
+ *
+ * The coroutine starts executing as soon as the step is first called, and
+ * runs until it either completes or suspends on an awaitable such as
+ * seq::event. Its frame is placed in a statically-allocated arena owned by the
+ * step; no heap allocation takes place.
+ *
+ * @see seq::async
+ */
+struct task {
+    struct promise_type {
+        // the event the coroutine is suspended on, if any
+        event *awaited{};
+
+        // resume the coroutine if the event it is suspended on has been set
+        auto resume_if_set() -> void;
+
+        [[nodiscard]] static auto operator new(std::size_t size) -> void * {
+            auto const storage = std::exchange(detail::next_frame, {});
+            CIB_ASSERT(storage.data != nullptr);
+            CIB_ASSERT(size <= storage.size);
+            return storage.data;
+        }
+        static auto operator delete(void *) noexcept -> void {}
+
+        auto get_return_object() -> task {
+            return task{
+                std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        auto initial_suspend() const noexcept -> std::suspend_never {
+            return {};
+        }
+        auto final_suspend() const noexcept -> std::suspend_always {
+            return {};
+        }
+        auto return_void() const noexcept -> void {}
+        [[noreturn]] auto unhandled_exception() const noexcept -> void {
+            std::terminate();
+        }
+    };
+
+    std::coroutine_handle<promise_type> handle{};
+};
+
+/**
+ * An awaitable event that can be signalled from an interrupt or a callback.
+ *
+ * A seq::task coroutine that awaits an event which has not been set is
+ * suspended. set() only marks the event: the coroutine is resumed by the next
+ * call of its step, so the rest of the step runs in the sequencer's context,
+ * never in the interrupt that called set(). A set() with no waiting coroutine
+ * is remembered until the next co_await.
+ */
+class event {
+    bool ready{};
+
+    friend struct task::promise_type;
+
+    [[nodiscard]] auto take() -> bool {
+        return conc::call_in_critical_section<event>(
+            [&] { return std::exchange(ready, false); });
+    }
+
+    struct awaiter {
+        event &e;
+
+        [[nodiscard]] auto await_ready() const -> bool { return e.take(); }
+
+        auto await_suspend(std::coroutine_handle<task::promise_type> h) const
+            -> bool {
+            if (e.take()) {
+                return false;
+            }
+            h.promise().awaited = &e;
+            return true;
+        }
+
+        auto await_resume() const noexcept -> void {}
+    };
+
+  public:
+    /**
+     * Signal the event. A coroutine waiting on it is resumed when its step is
+     * next called.
+     */
+    auto set() -> void {
+        conc::call_in_critical_section<event>([&] { ready = true; });
+    }
+
+    /**
+     * Forget a signal that has not yet been awaited.
+     */
+    auto reset() -> void {
+        conc::call_in_critical_section<event>([&] { ready = false; });
+    }
+
+    [[nodiscard]] auto operator co_await() -> awaiter { return {*this}; }
+};
+
+inline auto task::promise_type::resume_if_set() -> void {
+    if (awaited != nullptr and awaited->take()) {
+        awaited = nullptr;
+        std::coroutine_handle<promise_type>::from_promise(*this).resume();
+    }
+}
+
+namespace detail {
+template <auto Coroutine, std::size_t FrameSize> struct async_step {
+    alignas(std::max_align_t) CONSTINIT
+        static inline std::array<std::byte, FrameSize> arena{};
+    CONSTINIT static inline std::coroutine_handle<task::promise_type> current{};
+
+    static auto run() -> status {
+        if (not current) {
+            next_frame = {arena.data(), FrameSize};
+            current = Coroutine().handle;
+        } else {
+            current.promise().resume_if_set();
+        }
+        if (not current.done()) {
+            return status::NOT_DONE;
+        }
+        std::exchange(current, {}).destroy();
+        return status::DONE;
+    }
+};
+} // namespace detail
+
+/**
+ * Adapt a coroutine returning seq::task to a seq step function.
+ *
+ * The first call starts the coroutine. Each later call resumes it if the
+ * event it is suspended on has been set, and returns NOT_DONE until it has
+ * completed, at which point the step is DONE and the next call will start it
+ * again. So the coroutine only ever runs inside a call of its step.
+ *
+ * @tparam Coroutine
+ *      A function taking no arguments and returning seq::task.
+ *
+ * @tparam FrameSize
+ *      The size in bytes of the static arena holding the coroutine frame. The
+ *      frame size is only known to the compiler, so this is checked with
+ *      CIB_ASSERT when the coroutine starts.
+ *
+ * @see seq::step
+ */
+template <auto Coroutine, std::size_t FrameSize = 256>
+constexpr func_ptr async = detail::async_step<Coroutine, FrameSize>::run;
+} // namespace seq
@@ -1,65 +1,155 @@
 #pragma once
 
+#include <flow/graph_builder.hpp>
 #include <log/log.hpp>
 #include <seq/step.hpp>
 
 #include <stdx/cx_vector.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <span>
 
 namespace seq {
 enum struct direction { FORWARD = 0, BACKWARD = 1 };
 
+namespace detail {
+/**
+ * A fixed-size set of step indices.
+ */
+template <std::size_t N> struct step_mask {
+    constexpr static auto bits_per_word = 32u;
+    std::array<std::uint32_t, (N + bits_per_word - 1) / bits_per_word> words{};
+
+    constexpr auto set(std::size_t i) -> void {
+        words[i / bits_per_word] |= 1u << (i % bits_per_word);
+    }
+
+    constexpr auto reset(std::size_t i) -> void {
+        words[i / bits_per_word] &= ~(1u << (i % bits_per_word));
+    }
+
+    [[nodiscard]] constexpr auto test(std::size_t i) const -> bool {
+        return (words[i / bits_per_word] & (1u << (i % bits_per_word))) != 0;
+    }
+
+    [[nodiscard]] constexpr auto none() const -> bool {
+        return std::all_of(std::cbegin(words), std::cend(words),
+                           [](auto w) { return w == 0; });
+    }
+
+    [[nodiscard]] constexpr auto contains(step_mask const &other) const
+        -> bool {
+        for (auto i = std::size_t{}; i < std::size(words); ++i) {
+            if ((other.words[i] & ~words[i]) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] constexpr auto intersects(step_mask const &other) const
+        -> bool {
+        for (auto i = std::size_t{}; i < std::size(words); ++i) {
+            if ((other.words[i] & words[i]) != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+} // namespace detail
+
+/**
+ * seq::impl is the runtime representation of a sequence of steps that can be
+ * run forwards and backwards.
+ *
+ * Steps are run according to their dependencies rather than strictly one at a
+ * time. Going forward, each call polls every step whose predecessors have all
+ * completed; going backward, every step whose successors have all been undone.
+ * A step that is NOT_DONE only holds back the steps that depend on it.
+ *
+ * Each call makes one pass over the steps in dependency order, so each step is
+ * polled at most once per call, but a step that becomes ready during the pass
+ * is polled in the same call.
+ *
+ * @tparam NumSteps
+ *      The maximum number of steps this seq::impl represents.
+ *
+ * @see seq::builder
+ */
 template <typename, std::size_t NumSteps> struct impl {
+    using step_mask = detail::step_mask<NumSteps>;
+
     stdx::cx_vector<func_ptr, NumSteps> _forward_steps{};
     stdx::cx_vector<func_ptr, NumSteps> _backward_steps{};
-    std::size_t next_step{};
+    std::array<step_mask, NumSteps> _predecessors{};
+    std::array<step_mask, NumSteps> _successors{};
 
-    status prev_status{status::DONE};
+    step_mask completed{};
+    step_mask in_progress{};
     direction prev_direction{direction::BACKWARD};
 
-    constexpr explicit(true) impl(std::span<step_base const> steps) {
+    constexpr explicit(true) impl(std::span<step_base const> steps,
+                                  std::span<flow::edge const> edges = {}) {
         CIB_ASSERT(NumSteps >= std::size(steps));
         for (auto const &step : steps) {
             _forward_steps.push_back(step.forward_ptr);
             _backward_steps.push_back(step.backward_ptr);
         }
+        for (auto const &e : edges) {
+            _predecessors[e.to].set(e.from);
+            _successors[e.from].set(e.to);
+        }
     }
 
   private:
-    constexpr auto step_forward() -> status {
-        if (_forward_steps[next_step]() == status::NOT_DONE) {
-            return status::NOT_DONE;
-        }
-        ++next_step;
-        return status::DONE;
+    [[nodiscard]] constexpr auto num_steps() const -> std::size_t {
+        return std::size(_forward_steps);
     }
 
-    constexpr auto step_backward() -> status {
-        if (_backward_steps[next_step - 1]() == status::NOT_DONE) {
+    template <direction dir> constexpr auto step(std::size_t i) -> status {
+        auto const s = dir == direction::FORWARD ? _forward_steps[i]()
+                                                 : _backward_steps[i]();
+        if (s == status::NOT_DONE) {
+            in_progress.set(i);
             return status::NOT_DONE;
         }
-        --next_step;
+
+        in_progress.reset(i);
+        if constexpr (dir == direction::FORWARD) {
+            completed.set(i);
+        } else {
+            completed.reset(i);
+        }
         return status::DONE;
     }
 
-    template <direction dir> constexpr auto step() -> status {
+    template <direction dir>
+    [[nodiscard]] constexpr auto is_ready(std::size_t i) const -> bool {
         if constexpr (dir == direction::FORWARD) {
-            return step_forward();
+            return not completed.test(i) and
+                   completed.contains(_predecessors[i]);
         } else {
-            return step_backward();
+            return completed.test(i) and
+                   not completed.intersects(_successors[i]);
         }
     }
 
     template <direction dir>
-    [[nodiscard]] constexpr auto can_continue() const -> bool {
+    [[nodiscard]] constexpr auto is_finished() const -> bool {
         if constexpr (dir == direction::FORWARD) {
-            return next_step < NumSteps;
+            for (auto i = std::size_t{}; i < num_steps(); ++i) {
+                if (not completed.test(i)) {
+                    return false;
+                }
+            }
+            return true;
         } else {
-            return next_step > 0;
+            return completed.none();
         }
     }
 
@@ -76,23 +166,29 @@ template <typename, std::size_t NumSteps> struct impl {
         constexpr direction opposite_dir = opposite<dir>();
 
         // check if previous direction has finished or not
-        if (prev_direction == opposite_dir && prev_status == status::NOT_DONE &&
-            step<opposite_dir>() == status::NOT_DONE) {
-            return status::NOT_DONE;
+        if (prev_direction == opposite_dir) {
+            for (auto i = std::size_t{}; i < num_steps(); ++i) {
+                if (in_progress.test(i)) {
+                    step<opposite_dir>(i);
+                }
+            }
+            if (not in_progress.none()) {
+                return status::NOT_DONE;
+            }
         }
 
         prev_direction = dir;
 
-        // proceed in the requested direction
-        while (can_continue<dir>()) {
-            if (step<dir>() == status::NOT_DONE) {
-                prev_status = status::NOT_DONE;
-                return status::NOT_DONE;
+        // proceed in the requested direction, in dependency order
+        for (auto n = std::size_t{}; n < num_steps(); ++n) {
+            auto const i =
+                dir == direction::FORWARD ? n : num_steps() - 1 - n;
+            if (is_ready<dir>(i)) {
+                step<dir>(i);
             }
         }
 
-        prev_status = status::DONE;
-        return status::DONE;
+        return is_finished<dir>() ? status::DONE : status::NOT_DONE;
     }
 
   public:
@@ -2,6 +2,8 @@
 
 #include <log/log.hpp>
 
+#include <string_view>
+
 namespace seq {
 enum struct status { NOT_DONE = 0, DONE = 1 };
 
@@ -14,6 +16,7 @@ struct step_base {
     func_ptr forward_ptr{};
     func_ptr backward_ptr{};
     log_func_ptr log_name{};
+    std::string_view name{};
 
   private:
     [[nodiscard]] constexpr friend auto operator==(step_base const &lhs,
@@ -33,6 +36,7 @@ struct step_base {
 template <typename Name>
 [[nodiscard]] constexpr auto step(Name, func_ptr forward, func_ptr backward)
     -> step_base {
-    return {forward, backward, [] { CIB_TRACE("seq.step({})", Name{}); }};
+    return {forward, backward, [] { CIB_TRACE("seq.step({})", Name{}); },
+            Name::value};
 }
 } // namespace seq
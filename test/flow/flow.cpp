@@ -282,6 +282,53 @@ TEST_CASE("add dependency rhs", "[flow]") {
     CHECK(actual.size() == 3);
 }
 
+TEST_CASE("resume runs nodes while the budget allows", "[flow]") {
+    flow::builder<> builder;
+    actual = "";
+
+    builder.add(a >> b >> c >> d);
+
+    auto const flow = builder.topo_sort<flow::impl, 4>();
+    REQUIRE(flow.has_value());
+    CHECK(flow->size() == 4);
+
+    auto budget = 0;
+    auto const take_two = [&] { return ++budget % 2 != 0; };
+
+    auto cursor = flow->resume(0, take_two);
+    CHECK(cursor == 2);
+    CHECK(actual == "ab");
+
+    cursor = flow->resume(cursor, take_two);
+    CHECK(cursor == 4);
+    CHECK(actual == "abcd");
+}
+
+TEST_CASE("resume always makes progress", "[flow]") {
+    flow::builder<decltype("ResumableFlow"_sc)> builder;
+    actual = "";
+
+    builder.add(a >> b);
+
+    auto const flow = builder.topo_sort<flow::impl, 2>();
+    REQUIRE(flow.has_value());
+
+    auto const no_budget = [] { return false; };
+    CHECK(flow->resume(0, no_budget) == 1);
+    CHECK(actual == "a");
+    CHECK(flow->resume(1, no_budget) == 2);
+    CHECK(actual == "ab");
+}
+
+TEST_CASE("resume an empty flow", "[flow]") {
+    flow::builder<> builder;
+    auto const flow = builder.topo_sort<flow::impl, 0>();
+    REQUIRE(flow.has_value());
+    auto const cursor = flow->resume(0, [] { return true; });
+    CHECK(cursor == 0);
+    CHECK(cursor == flow->size());
+}
+
 struct TestFlowAlpha : public flow::service<> {};
 struct TestFlowBeta : public flow::service<> {};
 
@@ -330,4 +377,46 @@ TEST_CASE("add multi action through cib::nexus, run through cib::service",
 
     CHECK(actual == "abcd");
 }
+
+struct TestResumableFlow : public flow::resumable_service<> {};
+
+struct ResumableFlowConfig {
+    constexpr static auto config =
+        cib::config(cib::exports<TestResumableFlow>,
+                    cib::extend<TestResumableFlow>(a >> b >> c));
+};
+
+TEST_CASE("resume a resumable flow through cib::nexus", "[flow]") {
+    cib::nexus<ResumableFlowConfig> nexus{};
+    nexus.init();
+
+    actual = "";
+
+    auto const one_node = [] { return false; };
+    CHECK(not flow::resume<TestResumableFlow>(one_node));
+    CHECK(actual == "a");
+    CHECK(not flow::resume<TestResumableFlow>(one_node));
+    CHECK(actual == "ab");
+    CHECK(flow::resume<TestResumableFlow>(one_node));
+    CHECK(actual == "abc");
+
+    CHECK(flow::resume<TestResumableFlow>([] { return true; }));
+    CHECK(actual == "abcabc");
+}
+
+TEST_CASE("resume a resumable flow with a stateful budget", "[flow]") {
+    cib::nexus<ResumableFlowConfig> nexus{};
+    nexus.init();
+
+    actual = "";
+
+    auto nodes_left = 2;
+    CHECK(not flow::resume<TestResumableFlow>(
+        [&] { return --nodes_left > 0; }));
+    CHECK(actual == "ab");
+
+    CHECK(flow::resume<TestResumableFlow>(
+        [n = 0]() mutable { return ++n < 3; }));
+    CHECK(actual == "abc");
+}
 } // namespace
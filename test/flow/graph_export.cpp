@@ -0,0 +1,51 @@
+#include <cib/cib.hpp>
+#include <flow/flow.hpp>
+#include <flow/graph_export.hpp>
+#include <seq/builder.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iterator>
+#include <string>
+
+namespace {
+constexpr auto a = flow::action("a"_sc, [] {});
+constexpr auto b = flow::action("b"_sc, [] {});
+constexpr auto c = flow::action("c"_sc, [] {});
+
+constexpr auto s = seq::step(
+    "s"_sc, [] { return seq::status::DONE; },
+    [] { return seq::status::DONE; });
+
+struct ExportFlow : public flow::service<> {};
+struct ExportSeq : public seq::service<> {};
+
+struct ExportConfig {
+    constexpr static auto config =
+        cib::config(cib::exports<ExportFlow, ExportSeq>,
+                    cib::extend<ExportFlow>(a >> b >> c),
+                    cib::extend<ExportSeq>(s));
+};
+
+TEST_CASE("export flow graph as json", "[graph_export]") {
+    std::string json{};
+    flow::export_json<ExportConfig>(std::back_inserter(json));
+
+    CHECK(json.find("ExportFlow") != std::string::npos);
+    CHECK(json.find(R"("order": ["a", "b", "c"])") != std::string::npos);
+    CHECK(json.find("[0, 1]") != std::string::npos);
+    CHECK(json.find("[1, 2]") != std::string::npos);
+    CHECK(json.find("ExportSeq") != std::string::npos);
+    CHECK(json.find(R"("order": ["s"])") != std::string::npos);
+}
+
+TEST_CASE("export flow graph as dot", "[graph_export]") {
+    std::string dot{};
+    flow::export_dot<ExportConfig>(std::back_inserter(dot));
+
+    CHECK(dot.starts_with("digraph cib {"));
+    CHECK(dot.find(R"([label="0: a"])") != std::string::npos);
+    CHECK(dot.find(R"([label="2: c"])") != std::string::npos);
+    CHECK(dot.find("_0 -> g") != std::string::npos);
+}
+} // namespace
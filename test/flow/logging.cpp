@@ -0,0 +1,61 @@
+#include <cib/cib.hpp>
+#include <flow/flow.hpp>
+#include <log/fmt/logger.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <iterator>
+#include <string>
+
+namespace {
+std::string log_buffer{};
+} // namespace
+
+template <>
+inline auto logging::config<> =
+    logging::fmt::config{std::back_inserter(log_buffer)};
+
+namespace {
+constexpr auto a = flow::action("a"_sc, [] {});
+constexpr auto m = flow::milestone("m"_sc);
+constexpr auto b = flow::action("b"_sc, [] {});
+
+struct NamedFlow : public flow::service<decltype("NamedFlow"_sc)> {};
+struct UnnamedFlow : public flow::service<> {};
+
+struct LoggingConfig {
+    constexpr static auto config =
+        cib::config(cib::exports<NamedFlow, UnnamedFlow>,
+                    cib::extend<NamedFlow>(a >> m >> b),
+                    cib::extend<UnnamedFlow>(a >> b));
+};
+
+TEST_CASE("a named flow traces its nodes by name", "[flow]") {
+    cib::nexus<LoggingConfig> nexus{};
+    nexus.init();
+    log_buffer.clear();
+
+    flow::run<NamedFlow>();
+
+    auto const start = log_buffer.find("flow.start(NamedFlow)");
+    auto const node_a = log_buffer.find("flow.node(NamedFlow, a)");
+    auto const node_m = log_buffer.find("flow.node(NamedFlow, m)");
+    auto const node_b = log_buffer.find("flow.node(NamedFlow, b)");
+    auto const end = log_buffer.find("flow.end(NamedFlow)");
+    REQUIRE(end != std::string::npos);
+    CHECK(start < node_a);
+    CHECK(node_a < node_m);
+    CHECK(node_m < node_b);
+    CHECK(node_b < end);
+}
+
+TEST_CASE("an unnamed flow is not traced", "[flow]") {
+    cib::nexus<LoggingConfig> nexus{};
+    nexus.init();
+    log_buffer.clear();
+
+    flow::run<UnnamedFlow>();
+
+    CHECK(log_buffer.empty());
+}
+} // namespace
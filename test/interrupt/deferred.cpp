@@ -0,0 +1,120 @@
+#include <interrupt/deferred.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace {
+std::vector<int> ran{};
+
+template <int N> auto record() -> void { ran.push_back(N); }
+} // namespace
+
+TEST_CASE("deferred routines run in order", "[deferred]") {
+    ran.clear();
+    interrupt::deferred_queue<4> q{};
+    CHECK(q.push(record<1>));
+    CHECK(q.push(record<2>));
+    CHECK(q.size() == 2);
+    CHECK(ran.empty());
+
+    CHECK(q.run() == 2);
+    CHECK(ran == std::vector<int>{1, 2});
+    CHECK(q.size() == 0);
+}
+
+TEST_CASE("a full deferred queue drops routines", "[deferred]") {
+    ran.clear();
+    interrupt::deferred_queue<2> q{};
+    CHECK(q.push(record<1>));
+    CHECK(q.push(record<2>));
+    CHECK(not q.push(record<3>));
+    CHECK(q.dropped_count() == 1);
+
+    q.run();
+    CHECK(ran == std::vector<int>{1, 2});
+    CHECK(q.push(record<3>));
+}
+
+TEST_CASE("the deferred queue wraps around", "[deferred]") {
+    ran.clear();
+    interrupt::deferred_queue<2> q{};
+    for (auto i = 0; i < 3; ++i) {
+        q.push(record<1>);
+        q.push(record<2>);
+        q.run();
+    }
+    CHECK(ran == std::vector<int>{1, 2, 1, 2, 1, 2});
+}
+
+namespace {
+interrupt::deferred_queue<4> *reentrant_queue{};
+
+auto push_during_run() -> void {
+    ran.push_back(0);
+    reentrant_queue->push(record<1>);
+}
+} // namespace
+
+TEST_CASE("routines queued while running are left for the next run",
+          "[deferred]") {
+    ran.clear();
+    interrupt::deferred_queue<4> q{};
+    reentrant_queue = &q;
+    q.push(push_during_run);
+
+    CHECK(q.run() == 1);
+    CHECK(ran == std::vector<int>{0});
+    CHECK(q.run() == 1);
+    CHECK(ran == std::vector<int>{0, 1});
+}
+
+TEST_CASE("defer and run_deferred use the global queue", "[deferred]") {
+    ran.clear();
+    interrupt::defer(record<5>);
+    CHECK(ran.empty());
+    CHECK(interrupt::run_deferred() == 1);
+    CHECK(ran == std::vector<int>{5});
+}
+
+namespace {
+std::array<std::atomic<std::size_t>, 2> runs_by_irq{};
+
+template <std::size_t Irq> auto count_run() -> void {
+    runs_by_irq[Irq].fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
+TEST_CASE("two irqs can defer to the same queue concurrently", "[deferred]") {
+    constexpr auto pushes_per_irq = std::size_t{20'000};
+    interrupt::deferred_queue<64> q{};
+    std::array<std::size_t, 2> queued{};
+
+    auto const irq = [&](auto index) {
+        constexpr auto i = decltype(index)::value;
+        for (auto n = std::size_t{}; n < pushes_per_irq; ++n) {
+            if (q.push(count_run<i>)) {
+                ++queued[i];
+            }
+        }
+    };
+
+    auto run = std::size_t{};
+    {
+        std::jthread irq0{irq, std::integral_constant<std::size_t, 0>{}};
+        std::jthread irq1{irq, std::integral_constant<std::size_t, 1>{}};
+        while (run + q.dropped_count() < 2 * pushes_per_irq) {
+            run += q.run();
+        }
+    }
+
+    CHECK(run == queued[0] + queued[1]);
+    CHECK(runs_by_irq[0] == queued[0]);
+    CHECK(runs_by_irq[1] == queued[1]);
+    CHECK(q.size() == 0);
+}
@@ -0,0 +1,125 @@
+#include <cib/cib.hpp>
+#include <interrupt/instrumentation.hpp>
+#include <log/fmt/logger.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace {
+struct fake_timestamp {
+    static inline std::uint32_t time{};
+    static auto now() -> std::uint32_t { return time; }
+};
+
+using timed = interrupt::timed_instrumentation<fake_timestamp>;
+
+std::string log_buffer{};
+} // namespace
+
+template <> inline auto interrupt::instrumentation<> = timed{};
+
+template <>
+inline auto logging::config<> =
+    logging::fmt::config{std::back_inserter(log_buffer)};
+
+namespace {
+
+struct uart_irq {};
+struct timer_irq {};
+} // namespace
+
+TEST_CASE("null instrumentation runs the isr", "[instrumentation]") {
+    auto ran = false;
+    interrupt::null::instrumentation::measure<interrupt::irq_key<1>>(
+        [&] { ran = true; });
+    CHECK(ran);
+    CHECK(interrupt::irq_statistics<1>().count == 0);
+}
+
+TEST_CASE("timed instrumentation counts and times", "[instrumentation]") {
+    timed::measure<interrupt::irq_key<7>>([] { fake_timestamp::time += 10; });
+    timed::measure<interrupt::irq_key<7>>([] { fake_timestamp::time += 30; });
+    timed::measure<interrupt::irq_key<7>>([] { fake_timestamp::time += 20; });
+
+    auto const &s = interrupt::irq_statistics<7>();
+    CHECK(s.count == 3);
+    CHECK(s.max_duration == 30);
+    CHECK(s.total_duration == 60);
+}
+
+TEST_CASE("sub_irq statistics are kept separately", "[instrumentation]") {
+    timed::measure<interrupt::sub_irq_key<uart_irq>>(
+        [] { fake_timestamp::time += 5; });
+
+    CHECK(interrupt::sub_irq_statistics<uart_irq>().count == 1);
+    CHECK(interrupt::sub_irq_statistics<uart_irq>().total_duration == 5);
+    CHECK(interrupt::sub_irq_statistics<timer_irq>().count == 0);
+}
+
+TEST_CASE("timed instrumentation handles timestamp wraparound",
+          "[instrumentation]") {
+    fake_timestamp::time = 0xffff'fff0u;
+    timed::measure<interrupt::irq_key<8>>([] { fake_timestamp::time += 0x20; });
+
+    CHECK(interrupt::irq_statistics<8>().max_duration == 0x20);
+}
+
+namespace {
+struct test_hal {
+    static auto init() -> void {}
+
+    template <bool Enable, std::size_t IrqNumber, std::size_t Priority>
+    static auto irqInit() -> void {}
+
+    template <typename StatusPolicy, typename Isr>
+    static auto run(std::size_t, Isr isr) -> void {
+        StatusPolicy::run([] {}, [&] { isr(); });
+    }
+};
+
+class busy_irq : public interrupt::irq_flow<decltype("busy_irq"_sc)> {};
+class idle_irq : public interrupt::irq_flow<decltype("idle_irq"_sc)> {};
+
+constexpr auto busy_action =
+    flow::action("busy_action"_sc, [] { fake_timestamp::time += 7; });
+
+using instrumented_config =
+    interrupt::root<test_hal,
+                    interrupt::irq<17, 0, busy_irq, interrupt::policies<>>,
+                    interrupt::irq<18, 0, idle_irq, interrupt::policies<>>>;
+
+struct instrumented_service : interrupt::service<instrumented_config> {};
+
+struct instrumented_project {
+    constexpr static auto config =
+        cib::config(cib::exports<instrumented_service>,
+                    interrupt::extend<instrumented_service, busy_irq>(
+                        busy_action));
+};
+} // namespace
+
+TEST_CASE("the manager measures each irq it runs", "[instrumentation]") {
+    cib::nexus<instrumented_project> nexus{};
+    nexus.init();
+    auto &manager = nexus.service<instrumented_service>;
+
+    manager.run<17>();
+    manager.run<17>();
+
+    auto const s = interrupt::irq_statistics<17>();
+    CHECK(s.count == 2);
+    CHECK(s.max_duration == 7);
+    CHECK(s.total_duration == 14);
+    CHECK(interrupt::irq_statistics<18>().count == 0);
+
+    log_buffer.clear();
+    interrupt::log_statistics<instrumented_config>();
+
+    CHECK(log_buffer.find("IRQ 17: count=2, max=7, total=14") !=
+          std::string::npos);
+    CHECK(log_buffer.find("IRQ 18: count=0, max=0, total=0") !=
+          std::string::npos);
+}
@@ -207,6 +207,17 @@ TEST_F(InterruptManagerTest, BasicManagerInit) {
     EXPECT_EQ(38, manager.max_irq());
 }
 
+TEST_F(InterruptManagerTest, EmptyManagerInit) {
+    manager_impl<MockIrqImpl, dynamic_controller<root<MockIrqImpl>>> const
+        manager{};
+
+    EXPECT_CALL(callback, init()).Times(1);
+
+    manager.init();
+
+    EXPECT_EQ(0, manager.max_irq());
+}
+
 TEST_F(InterruptManagerTest, BasicManagerIrqRun) {
     constexpr auto &manager = BasicBuilder::manager;
 
@@ -218,10 +229,9 @@ TEST_F(InterruptManagerTest, BasicManagerIrqRun) {
 TEST_F(InterruptManagerTest, BasicManagerSharedIrqRun) {
     constexpr auto &manager = BasicBuilder::manager;
 
-    EXPECT_READ(packet_avail_en_field_t).WillRepeatedly(Return(1));
-    EXPECT_READ(rsp_avail_en_field_t).WillRepeatedly(Return(0));
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0b10));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b11));
 
-    EXPECT_READ(packet_avail_sts_field_t).WillOnce(Return(1));
     EXPECT_WRITE(packet_avail_sts_field_t, 0);
 
     EXPECT_CALL(callback, run(33)).Times(1);
@@ -232,11 +242,8 @@ TEST_F(InterruptManagerTest, BasicManagerSharedIrqRun) {
 TEST_F(InterruptManagerTest, BasicManagerSharedIrqRunAllEnabled) {
     constexpr auto &manager = BasicBuilder::manager;
 
-    EXPECT_READ(packet_avail_en_field_t).WillRepeatedly(Return(1));
-    EXPECT_READ(rsp_avail_en_field_t).WillRepeatedly(Return(1));
-
-    EXPECT_READ(packet_avail_sts_field_t).WillOnce(Return(1));
-    EXPECT_READ(rsp_avail_sts_field_t).WillOnce(Return(1));
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0b11));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b11));
 
     EXPECT_WRITE(packet_avail_sts_field_t, 0);
     EXPECT_WRITE(rsp_avail_sts_field_t, 0);
@@ -249,8 +256,107 @@ TEST_F(InterruptManagerTest, BasicManagerSharedIrqRunAllEnabled) {
 TEST_F(InterruptManagerTest, BasicManagerSharedIrqRunAllDisabled) {
     constexpr auto &manager = BasicBuilder::manager;
 
-    EXPECT_READ(packet_avail_en_field_t).WillRepeatedly(Return(0));
-    EXPECT_READ(rsp_avail_en_field_t).WillRepeatedly(Return(0));
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b11));
+
+    EXPECT_WRITE(packet_avail_sts_field_t, _).Times(0);
+    EXPECT_WRITE(rsp_avail_sts_field_t, _).Times(0);
+
+    EXPECT_CALL(callback, run(33)).Times(1);
+
+    manager.run<33>();
+}
+
+struct BatchedClearBuilder {
+    using Config = root<
+        MockIrqImpl,
+
+        shared_irq<33, 0, policies<clear_status_first>,
+                   sub_irq<packet_avail_en_field_t, packet_avail_sts_field_t,
+                           msg_handler_irq,
+                           policies<clear_status_batched<>>>,
+                   sub_irq<rsp_avail_en_field_t, rsp_avail_sts_field_t,
+                           rsp_handler_irq,
+                           policies<clear_status_batched<>>>>>;
+
+    struct test_service : interrupt::service<Config> {};
+
+    struct test_project {
+        constexpr static auto config = cib::config(
+            cib::exports<test_service>,
+            interrupt::extend<test_service, msg_handler_irq>(msg_handler),
+            interrupt::extend<test_service, rsp_handler_irq>(rsp_handler));
+    };
+
+    CONSTINIT static inline cib::nexus<test_project> test_nexus{};
+    CONSTINIT static inline auto &manager = test_nexus.service<test_service>;
+};
+
+TEST_F(InterruptManagerTest, BatchedClearWritesStatusOnce) {
+    constexpr auto &manager = BatchedClearBuilder::manager;
+
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0b11));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b11));
+
+    EXPECT_WRITE(int_sts_reg_t, 0b11).Times(1);
+    EXPECT_WRITE(packet_avail_sts_field_t, _).Times(0);
+    EXPECT_WRITE(rsp_avail_sts_field_t, _).Times(0);
+
+    EXPECT_CALL(callback, status(33)).Times(1);
+    EXPECT_CALL(callback, run(33)).Times(1);
+
+    manager.run<33>();
+}
+
+TEST_F(InterruptManagerTest, BatchedClearOnlyClearsPending) {
+    constexpr auto &manager = BatchedClearBuilder::manager;
+
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0b01));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b11));
+
+    EXPECT_WRITE(int_sts_reg_t, 0b01).Times(1);
+
+    EXPECT_CALL(callback, status(33)).Times(1);
+    EXPECT_CALL(callback, run(33)).Times(1);
+
+    manager.run<33>();
+}
+
+struct PriorityBuilder {
+    using Config = root<
+        MockIrqImpl,
+
+        shared_irq<33, 0, policies<clear_status_first>,
+                   sub_irq<rsp_avail_en_field_t, rsp_avail_sts_field_t,
+                           rsp_handler_irq, policies<>>,
+                   sub_irq<packet_avail_en_field_t, packet_avail_sts_field_t,
+                           msg_handler_irq,
+                           policies<dispatch_priority<1>>>>>;
+
+    struct test_service : interrupt::service<Config> {};
+
+    struct test_project {
+        constexpr static auto config = cib::config(
+            cib::exports<test_service>,
+            interrupt::extend<test_service, msg_handler_irq>(msg_handler),
+            interrupt::extend<test_service, rsp_handler_irq>(rsp_handler));
+    };
+
+    CONSTINIT static inline cib::nexus<test_project> test_nexus{};
+    CONSTINIT static inline auto &manager = test_nexus.service<test_service>;
+};
+
+TEST_F(InterruptManagerTest, HigherPrioritySubIrqRunsFirst) {
+    constexpr auto &manager = PriorityBuilder::manager;
+
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0b11));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b11));
+
+    {
+        InSequence s;
+        EXPECT_WRITE(packet_avail_sts_field_t, 0);
+        EXPECT_WRITE(rsp_avail_sts_field_t, 0);
+    }
 
     EXPECT_CALL(callback, run(33)).Times(1);
 
@@ -299,6 +405,38 @@ TEST_F(InterruptManagerTest, NoIsrInit) {
     manager.init();
 }
 
+namespace {
+auto default_isr() -> void { callbackPtr->run(0xdefa17); }
+} // namespace
+
+TEST_F(InterruptManagerTest, VectorTable) {
+    constexpr auto const &manager =
+        cib::nexus<BasicBuilder::test_project>::service<
+            BasicBuilder::test_service>;
+    constexpr auto const &table = vector_table<manager, default_isr>;
+
+    static_assert(std::size(table) == 39);
+    static_assert(table[0] == default_isr);
+    static_assert(table[33] != default_isr);
+    static_assert(table[38] != default_isr);
+
+    EXPECT_CALL(callback, run(38)).Times(1);
+    table[38]();
+
+    EXPECT_CALL(callback, run(0xdefa17)).Times(1);
+    table[37]();
+}
+
+TEST_F(InterruptManagerTest, VectorTableInactiveIrq) {
+    constexpr auto const &manager =
+        cib::nexus<NoIsrBuilder::test_project>::service<
+            NoIsrBuilder::test_service>;
+    constexpr auto const &table = vector_table<manager, default_isr>;
+
+    static_assert(table[33] == default_isr);
+    static_assert(table[38] == default_isr);
+}
+
 struct ClearStatusFirstBuilder {
     // Configure Interrupts
     using Config =
@@ -362,6 +500,37 @@ TEST_F(InterruptManagerTest, DontClearStatusTest) {
     manager.run<38>();
 }
 
+constexpr static auto deferred_action =
+    flow::action("deferred_action"_sc, [] { callbackPtr->run(0xdefe44ed); });
+
+struct DeferredBuilder {
+    using Config =
+        root<MockIrqImpl, irq<38, 0, timer_irq, policies<deferred>>>;
+
+    struct test_service : interrupt::service<Config> {};
+
+    struct test_project {
+        constexpr static auto config = cib::config(
+            cib::exports<test_service>,
+            interrupt::extend<test_service, timer_irq>(deferred_action));
+    };
+
+    CONSTINIT static inline cib::nexus<test_project> test_nexus{};
+    CONSTINIT static inline auto &manager = test_nexus.service<test_service>;
+};
+
+TEST_F(InterruptManagerTest, DeferredIrqRunsOutsideInterrupt) {
+    constexpr auto &manager = DeferredBuilder::manager;
+
+    EXPECT_CALL(callback, run(38)).Times(1);
+    EXPECT_CALL(callback, run(0xdefe44ed)).Times(0);
+    manager.run<38>();
+    testing::Mock::VerifyAndClearExpectations(&callback);
+
+    EXPECT_CALL(callback, run(0xdefe44ed)).Times(1);
+    interrupt::run_deferred();
+}
+
 TEST_F(InterruptManagerTest, DynamicInterruptEnable) {
     BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
 
@@ -371,6 +540,8 @@ TEST_F(InterruptManagerTest, DynamicInterruptEnable) {
 }
 
 TEST_F(InterruptManagerTest, DynamicInterruptEnableMulti) {
+    BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
+
     EXPECT_WRITE(int_en_reg_t, 3);
 
     BasicBuilder::Dynamic::enable<msg_handler_irq, rsp_handler_irq>();
@@ -392,6 +563,8 @@ TEST_F(InterruptManagerTest, ResourceDisableEnable) {
 }
 
 TEST_F(InterruptManagerTest, ResourceDisableEnableMultiIrq) {
+    BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
+
     InSequence s;
 
     EXPECT_WRITE(int_en_reg_t, 3);
@@ -405,6 +578,8 @@ TEST_F(InterruptManagerTest, ResourceDisableEnableMultiIrq) {
 }
 
 TEST_F(InterruptManagerTest, ResourceDisableEnableBigResource) {
+    BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
+
     InSequence s;
 
     EXPECT_WRITE(int_en_reg_t, 3);
@@ -418,6 +593,8 @@ TEST_F(InterruptManagerTest, ResourceDisableEnableBigResource) {
 }
 
 TEST_F(InterruptManagerTest, ResourceDisableEnableMultiResource) {
+    BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
+
     InSequence s;
 
     EXPECT_WRITE(int_en_reg_t, 3);
@@ -436,6 +613,85 @@ TEST_F(InterruptManagerTest, ResourceDisableEnableMultiResource) {
     BasicBuilder::Dynamic::turn_on_resource<test_resource_beta>();
 }
 
+TEST_F(InterruptManagerTest, ResourceRepeatedDisable) {
+    BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
+
+    InSequence s;
+
+    EXPECT_WRITE(int_en_reg_t, 3);
+    BasicBuilder::Dynamic::enable<rsp_handler_irq, msg_handler_irq>();
+
+    EXPECT_WRITE(int_en_reg_t, 2);
+    BasicBuilder::Dynamic::turn_off_resource<test_resource_beta>();
+    BasicBuilder::Dynamic::turn_off_resource<test_resource_beta>();
+
+    EXPECT_WRITE(int_en_reg_t, 3);
+    BasicBuilder::Dynamic::turn_on_resource<test_resource_beta>();
+}
+
+TEST_F(InterruptManagerTest, UnchangedEnablesAreNotWritten) {
+    BasicBuilder::Dynamic::disable<msg_handler_irq, rsp_handler_irq>();
+
+    InSequence s;
+
+    EXPECT_WRITE(int_en_reg_t, 2);
+    BasicBuilder::Dynamic::enable<msg_handler_irq>();
+
+    EXPECT_WRITE(int_en_reg_t, _).Times(0);
+    BasicBuilder::Dynamic::enable<msg_handler_irq>();
+    // rsp_handler_irq is disabled, so losing test_resource_beta changes nothing
+    BasicBuilder::Dynamic::turn_off_resource<test_resource_beta>();
+    BasicBuilder::Dynamic::turn_on_resource<test_resource_beta>();
+}
+
+struct LockFreeBuilder {
+    using Config = root<
+        MockIrqImpl,
+
+        shared_irq<33, 0, policies<clear_status_first>,
+                   sub_irq<packet_avail_en_field_t, packet_avail_sts_field_t,
+                           msg_handler_irq,
+                           policies<required_resources<test_resource_alpha>>>,
+                   sub_irq<rsp_avail_en_field_t, rsp_avail_sts_field_t,
+                           rsp_handler_irq,
+                           policies<required_resources<test_resource_alpha,
+                                                       test_resource_beta>>>>>;
+
+    using Dynamic = dynamic_controller<Config>;
+};
+} // namespace interrupt
+
+template <>
+constexpr auto
+    interrupt::dynamic_update_policy<interrupt::LockFreeBuilder::Config> =
+        interrupt::lock_free_updates{};
+
+namespace interrupt {
+TEST_F(InterruptManagerTest, LockFreeResourceDisableEnable) {
+    using Dynamic = LockFreeBuilder::Dynamic;
+
+    InSequence s;
+
+    EXPECT_WRITE(int_en_reg_t, 3);
+    Dynamic::enable<rsp_handler_irq, msg_handler_irq>();
+
+    EXPECT_WRITE(int_en_reg_t, 2);
+    Dynamic::turn_off_resource<test_resource_beta>();
+    Dynamic::turn_off_resource<test_resource_beta>();
+
+    EXPECT_WRITE(int_en_reg_t, 0);
+    Dynamic::turn_off_resource<test_resource_alpha>();
+
+    EXPECT_WRITE(int_en_reg_t, 2);
+    Dynamic::turn_on_resource<test_resource_alpha>();
+
+    EXPECT_WRITE(int_en_reg_t, 3);
+    Dynamic::turn_on_resource<test_resource_beta>();
+
+    EXPECT_WRITE(int_en_reg_t, _).Times(0);
+    Dynamic::enable<msg_handler_irq>();
+}
+
 constexpr static auto bscan =
     flow::action("bscan"_sc, [] { callbackPtr->run(0xba5eba11); });
 
@@ -502,11 +758,8 @@ struct SharedSubIrqTest {
 TEST_F(InterruptManagerTest, BasicManagerSharedSubIrqRun) {
     constexpr auto &manager = SharedSubIrqTest::manager;
 
-    EXPECT_READ(hwio_int_en_field_t).WillRepeatedly(Return(1));
-    EXPECT_READ(i2c_int_en_field_t).WillRepeatedly(Return(1));
-
-    EXPECT_READ(hwio_int_sts_field_t).WillOnce(Return(1));
-    EXPECT_READ(i2c_int_sts_field_t).WillOnce(Return(1));
+    EXPECT_READ(int_en_reg_t).WillOnce(Return(0b111100));
+    EXPECT_READ(int_sts_reg_t).WillOnce(Return(0b001100));
 
     EXPECT_WRITE(hwio_int_sts_field_t, 0);
     EXPECT_WRITE(i2c_int_sts_field_t, 0);
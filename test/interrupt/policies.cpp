@@ -14,3 +14,23 @@ TEST_CASE("policies get", "[policies]") {
                                            default_policy_t>()),
                   default_policy_t>);
 }
+
+TEST_CASE("batched status clear runs without clearing", "[policies]") {
+    auto cleared = false;
+    auto ran = false;
+    interrupt::clear_status_batched<>::run([&] { cleared = true; },
+                                           [&] { ran = true; });
+    CHECK(ran);
+    CHECK(not cleared);
+}
+
+TEST_CASE("dispatch priority defaults to 0", "[policies]") {
+    using policies_t = interrupt::policies<interrupt::dispatch_priority<3>>;
+    static_assert(
+        policies_t::type<interrupt::dispatch_priority_policy,
+                         interrupt::dispatch_priority<>>::value == 3);
+    static_assert(
+        interrupt::policies<>::type<interrupt::dispatch_priority_policy,
+                                    interrupt::dispatch_priority<>>::value ==
+        0);
+}
@@ -8,6 +8,10 @@
 #include <iostream>
 #include <iterator>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace {
 auto log_test_override() { CIB_INFO("Hello"); }
@@ -95,3 +99,181 @@ TEST_CASE("logging can use std::cout", "[log]") {
     [[maybe_unused]] auto cfg =
         logging::fmt::config{std::ostream_iterator<char>{std::cout}};
 }
+
+namespace {
+auto ends_with(std::string_view s, std::string_view suffix) -> bool {
+    return s.size() >= suffix.size() and
+           s.substr(s.size() - suffix.size()) == suffix;
+}
+} // namespace
+
+TEST_CASE("buffered logging writes each record once", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::buffered<256>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    cfg.logger.log<logging::level::INFO>("file", 1, format("Hello {}"_sc, 17));
+    REQUIRE(writes.size() == 1);
+    CHECK(ends_with(writes[0], "INFO: Hello 17\n"));
+}
+
+TEST_CASE("buffered logging truncates long records", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::buffered<32>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    cfg.logger.log<logging::level::INFO>(
+        "file", 1, format("{}"_sc, std::string_view{"0123456789abcdefghij"}));
+    REQUIRE(writes.size() == 1);
+    CHECK(writes[0].size() == 32);
+    CHECK(writes[0].back() == '\n');
+}
+
+TEST_CASE("batched logging writes on flush", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::buffered<256, true>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    cfg.logger.log<logging::level::INFO>("file", 1, format("one {}"_sc, 1));
+    cfg.logger.log<logging::level::WARN>("file", 1, format("two {}"_sc, 2));
+    CHECK(writes.empty());
+
+    cfg.logger.flush();
+    REQUIRE(writes.size() == 1);
+    CHECK(writes[0].find("INFO: one 1\n") != std::string::npos);
+    CHECK(ends_with(writes[0], "WARN: two 2\n"));
+}
+
+TEST_CASE("batched logging writes when the buffer is full", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::buffered<32, true>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    cfg.logger.log<logging::level::INFO>("file", 1, format("one {}"_sc, 1));
+    cfg.logger.log<logging::level::INFO>("file", 1, format("two {}"_sc, 2));
+    REQUIRE(writes.size() == 1);
+    CHECK(ends_with(writes[0], "INFO: one 1\n"));
+
+    cfg.logger.flush();
+    REQUIRE(writes.size() == 2);
+    CHECK(ends_with(writes[1], "INFO: two 2\n"));
+}
+
+TEST_CASE("destroying a batched handler writes the thread's records",
+          "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto const dest = [&](std::string_view record) {
+        writes.emplace_back(record);
+    };
+    {
+        auto cfg =
+            logging::fmt::config{logging::fmt::buffered<256, true>{}, dest};
+        cfg.logger.log<logging::level::INFO>("file", 1, format("one {}"_sc, 1));
+        CHECK(writes.empty());
+    }
+    REQUIRE(writes.size() == 1);
+    CHECK(ends_with(writes[0], "INFO: one 1\n"));
+
+    // the thread's buffer no longer refers to the destroyed handler
+    auto cfg = logging::fmt::config{logging::fmt::buffered<256, true>{}, dest};
+    cfg.logger.log<logging::level::INFO>("file", 1, format("two {}"_sc, 2));
+    cfg.logger.flush();
+    REQUIRE(writes.size() == 2);
+    CHECK(ends_with(writes[1], "INFO: two 2\n"));
+}
+
+TEST_CASE("only an unbuffered handler can be copied or moved", "[log]") {
+    using dests_t = stdx::tuple<std::back_insert_iterator<std::string>>;
+    using unbuffered_t = logging::fmt::log_handler<dests_t>;
+    using batched_t =
+        logging::fmt::log_handler<dests_t, logging::fmt::buffered<64, true>>;
+    using deferred_t =
+        logging::fmt::log_handler<dests_t, logging::fmt::deferred<64>>;
+
+    static_assert(std::is_copy_constructible_v<unbuffered_t>);
+    static_assert(std::is_nothrow_move_constructible_v<unbuffered_t>);
+    static_assert(not std::is_copy_constructible_v<batched_t>);
+    static_assert(not std::is_move_constructible_v<batched_t>);
+    static_assert(not std::is_copy_assignable_v<deferred_t>);
+    static_assert(not std::is_move_assignable_v<deferred_t>);
+}
+
+TEST_CASE("deferred logging writes records when drained", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::deferred<256>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    cfg.logger.log<logging::level::INFO>("file", 1, format("one {}"_sc, 1));
+    cfg.logger.log<logging::level::WARN>("file", 1,
+                                         format("two {} {}"_sc, 2.5, 'x'));
+    CHECK(writes.empty());
+
+    CHECK(cfg.logger.drain() == 2);
+    REQUIRE(writes.size() == 2);
+    CHECK(ends_with(writes[0], "INFO: one 1\n"));
+    CHECK(ends_with(writes[1], "WARN: two 2.5 x\n"));
+    CHECK(cfg.logger.drain() == 0);
+}
+
+TEST_CASE("deferred logging drops records when a queue is full", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::deferred<64>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    for (auto i = 0; i < 3; ++i) {
+        cfg.logger.log<logging::level::INFO>("file", 1, format("{}"_sc, i));
+    }
+    CHECK(cfg.logger.dropped_count() == 1);
+    CHECK(cfg.logger.drain() == 2);
+    CHECK(ends_with(writes[1], "INFO: 1\n"));
+}
+
+TEST_CASE("deferred logging is written by a worker thread", "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::deferred<4096>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    {
+        auto worker = cfg.logger.start_worker();
+        std::thread{[&] {
+            for (auto i = 0; i < 100; ++i) {
+                cfg.logger.log<logging::level::INFO>("file", 1,
+                                                     format("{}"_sc, i));
+            }
+        }}.join();
+    }
+    REQUIRE(writes.size() == 100);
+    CHECK(ends_with(writes.back(), "INFO: 99\n"));
+}
+
+TEST_CASE("a prepared thread's deferred logging doesn't use dynamic memory",
+          "[log]") {
+    auto writes = std::vector<std::string>{};
+    auto cfg = logging::fmt::config{
+        logging::fmt::deferred<256>{},
+        [&](std::string_view record) { writes.emplace_back(record); }};
+    auto allocated = true;
+    std::thread{[&] {
+        cfg.logger.prepare_thread();
+        allocation_happened.store(false);
+        cfg.logger.log<logging::level::INFO>("file", 1, format("{}"_sc, 1));
+        allocated = allocation_happened.load();
+    }}.join();
+    CHECK(not allocated);
+    CHECK(cfg.logger.drain() == 1);
+    REQUIRE(writes.size() == 1);
+    CHECK(ends_with(writes[0], "INFO: 1\n"));
+}
+
+TEST_CASE("destroying a deferred handler drains its queues", "[log]") {
+    auto writes = std::vector<std::string>{};
+    {
+        auto cfg = logging::fmt::config{
+            logging::fmt::deferred<256>{},
+            [&](std::string_view record) { writes.emplace_back(record); }};
+        cfg.logger.log<logging::level::INFO>("file", 1, format("{}"_sc, 1));
+        CHECK(writes.empty());
+    }
+    REQUIRE(writes.size() == 1);
+    CHECK(ends_with(writes[0], "INFO: 1\n"));
+}
@@ -24,3 +24,54 @@ TEST_CASE("FATAL calls compile-time panic", "[log]") {
     CIB_FATAL("Hello");
     CHECK(panicked);
 }
+
+namespace {
+struct quiet_module {};
+
+int evaluations{};
+
+auto evaluate() -> int { return ++evaluations; }
+} // namespace
+
+template <>
+constexpr auto logging::module_level_threshold<quiet_module> =
+    logging::level::WARN;
+
+TEST_CASE("log statements above the level threshold are not evaluated",
+          "[log]") {
+    using cib_log_module = quiet_module;
+    static_assert(not logging::is_enabled<logging::level::TRACE, quiet_module>);
+    static_assert(logging::is_enabled<logging::level::WARN, quiet_module>);
+
+    evaluations = 0;
+    CIB_TRACE("{}", evaluate());
+    CIB_INFO("{}", evaluate());
+    CHECK(evaluations == 0);
+    CIB_WARN("{}", evaluate());
+    CIB_ERROR("{}", evaluate());
+    CHECK(evaluations == 2);
+}
+
+namespace quiet {
+using cib_log_module = quiet_module;
+
+auto log_at_every_level() -> void {
+    CIB_TRACE("{}", evaluate());
+    CIB_WARN("{}", evaluate());
+}
+} // namespace quiet
+
+TEST_CASE("a namespace can name its log module", "[log]") {
+    evaluations = 0;
+    quiet::log_at_every_level();
+    CHECK(evaluations == 1);
+}
+
+TEST_CASE("the default module logs at every level", "[log]") {
+    static_assert(
+        logging::is_enabled<logging::level::TRACE, logging::default_module>);
+
+    evaluations = 0;
+    CIB_TRACE("{}", evaluate());
+    CHECK(evaluations == 1);
+}
@@ -5,9 +5,14 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <span>
 #include <utility>
+#include <vector>
 
 namespace {
 struct [[nodiscard]] test_critical_section {
@@ -74,12 +79,87 @@ struct test_log_buf_destination {
         CHECK(((ExpectedArgs == *buf++) and ...));
     }
 };
+
+template <logging::level Level, std::uint32_t Subtype, auto... ExpectedArgs>
+struct test_log_packed_destination {
+    constexpr static auto expected_header =
+        (Subtype << 24u) | (static_cast<std::uint32_t>(Level) << 4u) | 0x3u;
+
+    template <typename... Args>
+    auto log_by_args(std::uint32_t header, Args... args) {
+        CHECK(header == expected_header);
+        CHECK(sizeof...(Args) == sizeof...(ExpectedArgs));
+        CHECK(((ExpectedArgs == args) and ...));
+        ++num_log_args_calls;
+    }
+
+    auto log_by_buf(std::uint32_t *buf, std::uint32_t size) const {
+        CHECK(size == 1 + sizeof...(ExpectedArgs));
+        CHECK(*buf++ == expected_header);
+        CHECK(((ExpectedArgs == *buf++) and ...));
+        ++num_log_args_calls;
+    }
+};
+
+std::vector<std::uint32_t> captured_words{};
+
+struct test_log_capture_destination {
+    template <typename... Words> auto log_by_args(Words... words) {
+        captured_words = {words...};
+    }
+
+    auto log_by_buf(std::uint32_t *buf, std::uint32_t size) const {
+        captured_words.assign(buf, buf + size);
+    }
+};
+
+std::uint64_t test_time{};
+
+std::vector<std::vector<std::uint32_t>> captured_records{};
+
+struct test_log_records_destination {
+    template <typename... Words> auto log_by_args(Words... words) {
+        captured_records.push_back({words...});
+    }
+};
+
+// called once, as if an interrupt preempted the next record before it is sent
+std::function<void()> preemption{};
+
+struct test_log_preempted_destination {
+    template <typename... Words> auto log_by_args(Words... words) {
+        if (auto f = std::exchange(preemption, nullptr)) {
+            f();
+        }
+        captured_records.push_back({words...});
+    }
+};
 } // namespace
 
 template <typename StringType> auto catalog() -> string_id {
     return test_string_id;
 }
 
+namespace {
+constexpr module_id test_module_id = 3u;
+struct test_module {};
+using test_module_string = decltype(to_module<test_module>())::type;
+} // namespace
+
+template <>
+std::atomic<std::uint8_t> catalog_module_quietness<test_module_string>{};
+
+namespace {
+
+std::array<std::atomic<std::uint8_t>, 3> other_module_quietness{};
+std::array<std::atomic<std::uint8_t> *const, 4> module_levels{
+    &other_module_quietness[0], &other_module_quietness[1],
+    &other_module_quietness[2], &catalog_module_quietness<test_module_string>};
+} // namespace
+
+std::span<std::atomic<std::uint8_t> *const> const catalog_module_levels{
+    module_levels};
+
 template <> inline auto conc::injected_policy<> = test_conc_policy{};
 
 TEST_CASE("log id", "[mipi]") {
@@ -145,3 +225,169 @@ TEST_CASE("log to multiple destinations", "[mipi]") {
     CHECK(test_critical_section::count == 4);
     CHECK(num_log_args_calls == 2);
 }
+
+TEST_CASE("runtime level filters log statements", "[mipi]") {
+    num_log_args_calls = 0;
+    auto cfg = logging::mipi::config{
+        test_log_args_destination<logging::level::INFO, 42u, 17u>{}};
+    CHECK(cfg.logger.get_level(test_module_id) == logging::level::TRACE);
+
+    cfg.logger.log_module<logging::level::INFO, test_module>(
+        "file", 1, format("{}"_sc, 17u));
+    CHECK(num_log_args_calls == 1);
+
+    cfg.logger.set_level(test_module_id, logging::level::WARN);
+    CHECK(cfg.logger.get_level(test_module_id) == logging::level::WARN);
+    cfg.logger.log_module<logging::level::INFO, test_module>(
+        "file", 1, format("{}"_sc, 17u));
+    CHECK(num_log_args_calls == 1);
+
+    cfg.logger.set_level(logging::level::TRACE);
+    cfg.logger.log_module<logging::level::INFO, test_module>(
+        "file", 1, format("{}"_sc, 17u));
+    CHECK(num_log_args_calls == 2);
+}
+
+TEST_CASE("runtime levels are per module", "[mipi]") {
+    auto cfg = logging::mipi::config{
+        test_log_args_destination<logging::level::TRACE>{}};
+    cfg.logger.set_level(1, logging::level::ERROR);
+    CHECK(not cfg.logger.is_enabled(logging::level::WARN, 1));
+    CHECK(cfg.logger.is_enabled(logging::level::ERROR, 1));
+    CHECK(cfg.logger.is_enabled(logging::level::TRACE, 2));
+
+    // modules unknown to the string catalog are ignored
+    cfg.logger.set_level(1000, logging::level::FATAL);
+    CHECK(cfg.logger.get_level(1000) == logging::level::TRACE);
+    CHECK(cfg.logger.get_level(2) == logging::level::TRACE);
+    cfg.logger.set_level(logging::level::TRACE);
+}
+
+TEST_CASE("8 and 16-bit arguments are promoted to 32 bits", "[mipi]") {
+    num_log_args_calls = 0;
+    auto cfg = logging::mipi::config{
+        test_log_packed_destination<logging::level::TRACE, 0x1u, 42u, 0x12u,
+                                    0x3456u, 1u, 0xffff'ffffu>{}};
+    cfg.logger.log_msg<logging::level::TRACE>(
+        format("{} {} {} {}"_sc, std::uint8_t{0x12u}, std::uint16_t{0x3456u},
+               true, std::int8_t{-1}));
+    CHECK(num_log_args_calls == 1);
+}
+
+TEST_CASE("64-bit arguments are not truncated", "[mipi]") {
+    num_log_args_calls = 0;
+    auto cfg = logging::mipi::config{
+        test_log_packed_destination<logging::level::TRACE, 0x1u, 42u,
+                                    0x5566'7788u, 0x1122'3344u>{}};
+    cfg.logger.log_msg<logging::level::TRACE>(
+        format("{}"_sc, std::uint64_t{0x1122'3344'5566'7788u}));
+    CHECK(num_log_args_calls == 1);
+}
+
+TEST_CASE("only 64-bit arguments take two words", "[mipi]") {
+    num_log_args_calls = 0;
+    auto cfg = logging::mipi::config{
+        test_log_packed_destination<logging::level::TRACE, 0x1u, 42u,
+                                    0xffff'fffeu, 0xffff'ffffu, 0xffff'ffffu,
+                                    17u>{}};
+    cfg.logger.log_msg<logging::level::TRACE>(format(
+        "{} {} {}"_sc, std::int64_t{-2}, std::int8_t{-1}, std::uint16_t{17u}));
+    CHECK(num_log_args_calls == 1);
+}
+
+TEST_CASE("full timestamps", "[mipi]") {
+    test_time = 0x1'0000'0005u;
+    auto cfg = logging::mipi::config{
+        logging::mipi::full_timestamps{[] { return test_time; }},
+        test_log_capture_destination{}};
+    constexpr auto header =
+        expected_catalog32_header(logging::level::TRACE) | (1u << 11u);
+
+    // messages without arguments are not short messages when timestamped
+    cfg.logger.log_msg<logging::level::TRACE>("Hello"_sc);
+    CHECK(captured_words ==
+          std::vector<std::uint32_t>{header, 5u, 1u, test_string_id});
+
+    cfg.logger.log_msg<logging::level::TRACE>(
+        format("{} {} {}"_sc, 17u, 18u, 19u));
+    CHECK(captured_words == std::vector<std::uint32_t>{header, 5u, 1u,
+                                                       test_string_id, 17u,
+                                                       18u, 19u});
+}
+
+TEST_CASE("delta timestamps", "[mipi]") {
+    test_time = 0x1'0000'0005u;
+    auto cfg = logging::mipi::config{
+        logging::mipi::delta_timestamps{[] { return test_time; }},
+        test_log_capture_destination{}};
+    constexpr auto full_header =
+        expected_catalog32_header(logging::level::TRACE) | (1u << 11u);
+    constexpr auto delta_header = full_header | (1u << 7u);
+
+    cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 17u));
+    CHECK(captured_words == std::vector<std::uint32_t>{full_header, 5u, 1u,
+                                                       test_string_id, 17u});
+
+    test_time += 10u;
+    cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 17u));
+    CHECK(captured_words == std::vector<std::uint32_t>{delta_header, 15u,
+                                                       test_string_id, 17u});
+
+    test_time += 0x1'0000'0000u;
+    cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 17u));
+    CHECK(captured_words == std::vector<std::uint32_t>{full_header, 15u, 2u,
+                                                       test_string_id, 17u});
+}
+
+TEST_CASE("delta timestamps wait until their sync point has been sent",
+          "[mipi]") {
+    captured_records.clear();
+    test_time = 0x1'0000'0005u;
+    auto cfg = logging::mipi::config{
+        logging::mipi::delta_timestamps{[] { return test_time; }},
+        test_log_preempted_destination{}};
+    constexpr auto full_header =
+        expected_catalog32_header(logging::level::TRACE) | (1u << 11u);
+    constexpr auto delta_header = full_header | (1u << 7u);
+
+    preemption = [&] {
+        ++test_time;
+        cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 18u));
+    };
+    cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 17u));
+    ++test_time;
+    cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 19u));
+
+    // the preempting record reaches the decoder first, so it cannot rely on
+    // the full timestamp of the record it preempted
+    CHECK(captured_records ==
+          std::vector<std::vector<std::uint32_t>>{
+              {full_header, 6u, 1u, test_string_id, 18u},
+              {full_header, 5u, 1u, test_string_id, 17u},
+              {delta_header, 7u, test_string_id, 19u}});
+}
+
+TEST_CASE("rate limit suppresses records beyond the burst", "[mipi]") {
+    captured_records.clear();
+    auto cfg = logging::mipi::config{logging::mipi::rate_limit<2>{},
+                                     test_log_records_destination{}};
+    for (auto i = 0; i < 5; ++i) {
+        cfg.logger.log_msg<logging::level::ERROR>(format("{}"_sc, 17u));
+    }
+    CHECK(captured_records.size() == 2);
+
+    // the summary carries the number suppressed and the call site's string
+    captured_records.clear();
+    cfg.logger.report_suppressed();
+    CHECK(captured_records ==
+          std::vector<std::vector<std::uint32_t>>{
+              {expected_catalog32_header(logging::level::WARN),
+               test_string_id, 3u, test_string_id}});
+
+    // a new period lets the call site log again
+    captured_records.clear();
+    cfg.logger.log_msg<logging::level::ERROR>(format("{}"_sc, 17u));
+    CHECK(captured_records.size() == 1);
+    cfg.logger.report_suppressed();
+    CHECK(captured_records.size() == 1);
+}
@@ -0,0 +1,58 @@
+#include <log/log.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <type_traits>
+
+namespace {
+struct global_module {};
+
+int evaluations{};
+
+auto evaluate() -> int { return ++evaluations; }
+} // namespace
+
+template <>
+constexpr auto logging::module_level_threshold<global_module> =
+    logging::level::WARN;
+
+using cib_log_module = global_module;
+
+namespace {
+// a log statement is an expression, valid outside block scope too
+auto const evaluated_at_namespace_scope =
+    (CIB_TRACE("{}", evaluate()), CIB_WARN("{}", evaluate()), evaluations);
+
+struct logs_in_member_initializer {
+    int evaluated = (CIB_TRACE("{}", evaluate()), evaluations);
+};
+} // namespace
+
+namespace loud {
+using cib_log_module = logging::default_module;
+
+auto log_trace() -> void { CIB_TRACE("{}", evaluate()); }
+} // namespace loud
+
+TEST_CASE("a global module alias applies to the translation unit", "[log]") {
+    static_assert(std::is_same_v<CIB_LOG_MODULE_T, global_module>);
+
+    evaluations = 0;
+    CIB_TRACE("{}", evaluate());
+    CHECK(evaluations == 0);
+    CIB_WARN("{}", evaluate());
+    CHECK(evaluations == 1);
+}
+
+TEST_CASE("a namespace module alias overrides the global one", "[log]") {
+    evaluations = 0;
+    loud::log_trace();
+    CHECK(evaluations == 1);
+}
+
+TEST_CASE("log statements need not be in block scope", "[log]") {
+    CHECK(evaluated_at_namespace_scope == 1);
+
+    evaluations = 0;
+    CHECK(logs_in_member_initializer{}.evaluated == 0);
+}
@@ -0,0 +1,143 @@
+#include <conc/concurrency.hpp>
+#include <log/catalog/mipi_encoder.hpp>
+#include <log/catalog/ring_buffer_destination.hpp>
+
+#include <stdx/concepts.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+struct test_conc_policy {
+    template <typename = void, stdx::invocable F, stdx::predicate... Pred>
+        requires(sizeof...(Pred) < 2)
+    static inline auto call_in_critical_section(F &&f, Pred &&...pred)
+        -> decltype(std::forward<F>(f)()) {
+        ++count;
+        while (not(... and pred())) {
+        }
+        return std::forward<F>(f)();
+    }
+
+    static inline int count = 0;
+};
+
+using frames_t = std::vector<std::vector<std::uint32_t>>;
+
+auto collect(frames_t &frames) {
+    return [&](std::span<std::uint32_t const> frame) {
+        frames.emplace_back(std::begin(frame), std::end(frame));
+    };
+}
+
+std::size_t current_ring{};
+
+struct test_ring_index {
+    static auto index() -> std::size_t { return current_ring; }
+};
+} // namespace
+
+template <typename StringType> auto catalog() -> string_id { return 42u; }
+
+template <> inline auto conc::injected_policy<> = test_conc_policy{};
+
+TEST_CASE("frames are drained in order", "[ring_buffer_destination]") {
+    auto rings = logging::mipi::log_rings<16>{};
+    CHECK(rings.log_by_args(1u, 2u));
+    CHECK(rings.log_by_args(3u));
+
+    auto frames = frames_t{};
+    CHECK(rings.drain(collect(frames)) == 2);
+    CHECK(frames == frames_t{{1u, 2u}, {3u}});
+    CHECK(rings.drain(collect(frames)) == 0);
+}
+
+TEST_CASE("frames can be written from a buffer", "[ring_buffer_destination]") {
+    auto rings = logging::mipi::log_rings<16>{};
+    auto const buf = std::array{1u, 2u, 3u, 4u};
+    CHECK(rings.log_by_buf(buf.data(), 4));
+
+    auto frames = frames_t{};
+    CHECK(rings.drain(collect(frames)) == 1);
+    CHECK(frames == frames_t{{1u, 2u, 3u, 4u}});
+}
+
+TEST_CASE("empty frames are ignored", "[ring_buffer_destination]") {
+    auto rings = logging::mipi::log_rings<16>{};
+    auto const buf = std::array{1u};
+    CHECK(not rings.log_by_buf(buf.data(), 0));
+    CHECK(rings.log_by_buf(buf.data(), 1));
+
+    auto frames = frames_t{};
+    CHECK(rings.drain(collect(frames)) == 1);
+    CHECK(frames == frames_t{{1u}});
+    CHECK(rings.dropped_count() == 0);
+}
+
+TEST_CASE("frames are not split at the end of a ring",
+          "[ring_buffer_destination]") {
+    auto rings = logging::mipi::log_rings<8>{};
+    auto frames = frames_t{};
+
+    CHECK(rings.log_by_args(1u, 2u, 3u, 4u));
+    CHECK(rings.drain(collect(frames)) == 1);
+
+    // 3 words remain before the end: this frame needs 4
+    CHECK(rings.log_by_args(5u, 6u, 7u));
+    CHECK(rings.drain(collect(frames)) == 1);
+    CHECK(frames == frames_t{{1u, 2u, 3u, 4u}, {5u, 6u, 7u}});
+    CHECK(rings.dropped_count() == 0);
+}
+
+TEST_CASE("frames are dropped when a ring is full",
+          "[ring_buffer_destination]") {
+    auto rings = logging::mipi::log_rings<8>{};
+    CHECK(rings.log_by_args(1u, 2u, 3u));
+    CHECK(rings.log_by_args(4u, 5u, 6u));
+    CHECK(not rings.log_by_args(7u));
+    CHECK(rings.dropped_count() == 1);
+
+    auto frames = frames_t{};
+    CHECK(rings.drain(collect(frames)) == 2);
+    CHECK(rings.log_by_args(7u));
+}
+
+TEST_CASE("producers write to the ring given by the ring index",
+          "[ring_buffer_destination]") {
+    auto rings = logging::mipi::log_rings<8, 2, test_ring_index>{};
+    current_ring = 1;
+    CHECK(rings.log_by_args(1u));
+    current_ring = 0;
+    CHECK(rings.log_by_args(2u));
+
+    auto frames = frames_t{};
+    CHECK(rings.drain(collect(frames)) == 2);
+    CHECK(frames == frames_t{{2u}, {1u}});
+}
+
+TEST_CASE("log_handler does not enter a critical section for a lock-free "
+          "destination",
+          "[ring_buffer_destination]") {
+    test_conc_policy::count = 0;
+    auto rings = logging::mipi::log_rings<16>{};
+    auto cfg = logging::mipi::config{
+        logging::mipi::ring_buffer_destination{rings}};
+    cfg.logger.log_msg<logging::level::TRACE>(format("{}"_sc, 17u));
+    cfg.logger.log_msg<logging::level::TRACE>(
+        format("{} {} {}"_sc, 1u, 2u, 3u));
+    CHECK(test_conc_policy::count == 0);
+
+    auto frames = frames_t{};
+    CHECK(rings.drain(collect(frames)) == 2);
+    REQUIRE(frames.size() == 2);
+    CHECK(frames[0].size() == 3);
+    CHECK(frames[0][1] == 42u);
+    CHECK(frames[0][2] == 17u);
+    CHECK(frames[1].size() == 5);
+}
@@ -0,0 +1,75 @@
+#include <seq/async.hpp>
+#include <seq/builder.hpp>
+#include <seq/impl.hpp>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+
+namespace {
+std::string result;
+seq::event ready;
+
+auto power_up() -> seq::task {
+    result += "A";
+    co_await ready;
+    result += "B";
+}
+
+auto power_down() -> seq::task {
+    result += "D";
+    co_return;
+}
+} // namespace
+
+TEST_CASE("async step suspends until its event is set", "[seq_async]") {
+    result = "";
+    ready.reset();
+
+    auto const step = seq::async<power_up>;
+    CHECK(step() == seq::status::NOT_DONE);
+    CHECK(result == "A");
+    CHECK(step() == seq::status::NOT_DONE);
+    CHECK(result == "A");
+
+    // set() may be called from an interrupt: the step resumes only when it
+    // is next called, not in the caller of set()
+    ready.set();
+    CHECK(result == "A");
+    CHECK(step() == seq::status::DONE);
+    CHECK(result == "AB");
+}
+
+TEST_CASE("async step can run again after completion", "[seq_async]") {
+    result = "";
+    ready.reset();
+
+    auto const step = seq::async<power_up>;
+    ready.set();
+    CHECK(step() == seq::status::DONE);
+    CHECK(result == "AB");
+    ready.set();
+    CHECK(step() == seq::status::DONE);
+    CHECK(result == "ABAB");
+}
+
+TEST_CASE("async steps in a seq", "[seq_async]") {
+    result = "";
+    ready.reset();
+
+    seq::builder<> builder;
+    builder.add(
+        seq::step("S"_sc, seq::async<power_up>, seq::async<power_down>));
+    auto seq_impl = builder.topo_sort<seq::impl, 1>();
+
+    CHECK(seq_impl->forward() == seq::status::NOT_DONE);
+    CHECK(seq_impl->forward() == seq::status::NOT_DONE);
+    CHECK(result == "A");
+
+    ready.set();
+    CHECK(result == "A");
+    CHECK(seq_impl->forward() == seq::status::DONE);
+    CHECK(result == "AB");
+    CHECK(seq_impl->backward() == seq::status::DONE);
+    CHECK(result == "ABD");
+}
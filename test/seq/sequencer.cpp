@@ -191,3 +191,79 @@ TEST_CASE("build seq with three steps and run forwards and backwards",
     CHECK(seq_impl->backward() == seq::status::DONE);
     CHECK(result == "F1F2F3B3B2B1");
 }
+
+TEST_CASE("independent steps are not held up by a step that is not done",
+          "[seq]") {
+    result = "";
+    attempt_count = 0;
+    seq::builder<> builder;
+
+    auto slow = seq::step(
+        "slow"_sc,
+        []() -> seq::status {
+            result += "S";
+            return attempt_count++ < 2 ? seq::status::NOT_DONE
+                                       : seq::status::DONE;
+        },
+        []() -> seq::status {
+            result += "s";
+            return seq::status::DONE;
+        });
+
+    auto fast1 = seq::step(
+        "fast1"_sc,
+        []() -> seq::status {
+            result += "A";
+            return seq::status::DONE;
+        },
+        []() -> seq::status {
+            result += "a";
+            return seq::status::DONE;
+        });
+
+    auto fast2 = seq::step(
+        "fast2"_sc,
+        []() -> seq::status {
+            result += "B";
+            return seq::status::DONE;
+        },
+        []() -> seq::status {
+            result += "b";
+            return seq::status::DONE;
+        });
+
+    auto last = seq::step(
+        "last"_sc,
+        []() -> seq::status {
+            result += "L";
+            return seq::status::DONE;
+        },
+        []() -> seq::status {
+            result += "l";
+            return seq::status::DONE;
+        });
+
+    builder.add((slow >> last) && (fast1 >> fast2 >> last));
+
+    auto seq_impl = builder.topo_sort<seq::impl, 4>();
+
+    CHECK(seq_impl->forward() == seq::status::NOT_DONE);
+    CHECK(result.size() == 3);
+    CHECK(result.find('S') != std::string::npos);
+    CHECK(result.find('A') < result.find('B'));
+
+    result = "";
+    CHECK(seq_impl->forward() == seq::status::NOT_DONE);
+    CHECK(result == "S");
+
+    result = "";
+    CHECK(seq_impl->forward() == seq::status::DONE);
+    CHECK(result == "SL");
+
+    result = "";
+    CHECK(seq_impl->backward() == seq::status::DONE);
+    CHECK(result.size() == 4);
+    CHECK(result.find('l') == 0);
+    CHECK(result.find('b') < result.find('a'));
+    CHECK(result.find('s') != std::string::npos);
+}
@@ -0,0 +1,38 @@
+#!/usr/bin/env python3
+
+# Extract the string catalog symbols that a library refers to, for
+# gen_str_catalog.py.
+#
+# usage: catalog_symbols.py <nm> <library> <out.txt>
+#
+# Runs `nm -uC` on the library and keeps the undefined catalog<> and
+# catalog_module_quietness<> symbols, once each and sorted. The output file is
+# only rewritten when that set of symbols changes, so rebuilding a library
+# without changing its log strings does not regenerate the catalog.
+
+import os
+import subprocess
+import sys
+
+nm, library, output_file = sys.argv[1:4]
+
+undefined = subprocess.run(
+    [nm, "-uC", library], check=True, capture_output=True, text=True
+).stdout
+
+symbols = sorted(
+    {
+        line.strip()
+        for line in undefined.splitlines()
+        if " catalog<" in line or " catalog_module_quietness<" in line
+    }
+)
+content = "".join(s + "\n" for s in symbols)
+
+if os.path.exists(output_file):
+    with open(output_file, "r") as f:
+        if f.read() == content:
+            sys.exit(0)
+
+with open(output_file, "w") as f:
+    f.write(content)
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+
+# Merge runtime timing data into a flow graph exported with flow::export_json,
+# and write the annotated graph as JSON and DOT.
+#
+# usage: flow_profile.py <graphs.json> <profile.json> <out.json> <out.dot>
+#
+# The profile is a JSON object mapping a graph name to an object mapping node
+# names to durations (in any consistent unit), e.g.
+#     {"MainLoop": {"read_sensors": 120, "update_leds": 15}}
+# A graph name in the profile matches an exported graph if it is equal to the
+# exported name, or to its last component after "::".
+#
+# For each graph, the critical path (the longest chain of dependent nodes, by
+# total duration) is computed. Nodes and edges on the critical path are
+# highlighted in the DOT output; the difference between the sum of all node
+# durations and the critical path length is the time that could be saved by
+# running independent nodes concurrently.
+
+import json
+import sys
+
+graphs_file = sys.argv[1]
+profile_file = sys.argv[2]
+json_file = sys.argv[3]
+dot_file = sys.argv[4]
+
+
+def find_timings(profile, name):
+    for key, timings in profile.items():
+        if key == name or name.endswith("::" + key):
+            return timings
+    return {}
+
+
+def critical_path(nodes, edges, durations):
+    # nodes are already in topological order, so one pass suffices
+    predecessors = [[] for _ in nodes]
+    for src, dst in edges:
+        predecessors[dst].append(src)
+
+    finish = [0] * len(nodes)
+    via = [None] * len(nodes)
+    for i in range(len(nodes)):
+        start = 0
+        for p in predecessors[i]:
+            if finish[p] > start:
+                start = finish[p]
+                via[i] = p
+        finish[i] = start + durations[i]
+
+    if not nodes:
+        return 0, []
+    end = max(range(len(nodes)), key=lambda i: finish[i])
+    path = [end]
+    while via[path[-1]] is not None:
+        path.append(via[path[-1]])
+    return finish[end], list(reversed(path))
+
+
+def escape(s):
+    return s.replace("\\", "\\\\").replace('"', '\\"')
+
+
+with open(graphs_file, "r") as f:
+    graphs = json.load(f)["graphs"]
+
+with open(profile_file, "r") as f:
+    profile = json.load(f)
+
+dot_lines = ["digraph cib {"]
+
+for index, graph in enumerate(graphs):
+    timings = find_timings(profile, graph["name"])
+    durations = [timings.get(n, 0) for n in graph["order"]]
+    length, path = critical_path(graph["order"], graph["edges"], durations)
+
+    graph["durations"] = durations
+    graph["total"] = sum(durations)
+    graph["critical_path"] = path
+    graph["critical_path_length"] = length
+
+    on_path = set(path)
+    path_edges = set(zip(path, path[1:]))
+
+    dot_lines.append("  subgraph cluster_{} {{".format(index))
+    dot_lines.append(
+        '    label="{} (total {}, critical path {})";'.format(
+            escape(graph["name"]), graph["total"], length
+        )
+    )
+    for i, node in enumerate(graph["order"]):
+        style = ", style=bold, color=red" if i in on_path else ""
+        dot_lines.append(
+            '    g{}_{} [label="{}: {}\\n{}"{}];'.format(
+                index, i, i, escape(node), durations[i], style
+            )
+        )
+    for src, dst in graph["edges"]:
+        style = " [style=bold, color=red]" if (src, dst) in path_edges else ""
+        dot_lines.append(
+            "    g{}_{} -> g{}_{}{};".format(index, src, index, dst, style)
+        )
+    dot_lines.append("  }")
+
+dot_lines.append("}")
+
+json.dump(dict(graphs=graphs), open(json_file, "w"), indent=4)
+
+with open(dot_file, "w") as f:
+    f.write("\n".join(dot_lines) + "\n")
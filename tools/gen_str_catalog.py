@@ -1,14 +1,33 @@
 import re
-import sys
 import json
+import hashlib
+import argparse
 import xml.etree.ElementTree as et
 
 levels = ["MAX", "FATAL", "ERROR", "WARN", "INFO", "USER1", "USER2", "TRACE"]
 
-input_file = sys.argv[1]
-cpp_file = sys.argv[2]
-json_file = sys.argv[3]
-xml_file = sys.argv[4]
+parser = argparse.ArgumentParser()
+parser.add_argument(
+    "input_files", nargs="+", help="outputs of nm -uC, e.g. one per library"
+)
+parser.add_argument("cpp_file")
+parser.add_argument("json_file")
+parser.add_argument("xml_file")
+parser.add_argument(
+    "--known_ids",
+    help="JSON output of a previous run: its strings and modules keep their IDs",
+)
+parser.add_argument(
+    "--hash_ids",
+    action="store_true",
+    help="derive the IDs of new strings from a hash of their contents",
+)
+cli_args = parser.parse_args()
+
+input_files = cli_args.input_files
+cpp_file = cli_args.cpp_file
+json_file = cli_args.json_file
+xml_file = cli_args.xml_file
 
 # fwver_dash = sys.argv[5]
 # cust_name = sys.argv[6]
@@ -20,19 +39,12 @@ string_re = re.compile(
     "message<\(logging::level\)(\d+), sc::undefined<sc::args<(.*)>, char, (.*)>\s*>"
 )
 
-string_id = 0
-cataloged_strings = set()
+module_re = re.compile("^.+?(catalog_module_quietness<(.+)>)\s*$")
 
-out = open(cpp_file, "w")
+module_string_re = re.compile("sc::undefined<sc::args<>, char, (.*)>\s*")
 
-messages = []
-
-out.write(
-    """
-#include <log/catalog/catalog.hpp>
-
-"""
-)
+# short32 messages carry 28 bits of string ID
+max_string_id = 0x0FFFFFFF
 
 # https://stackoverflow.com/questions/174890/how-to-output-cdata-using-elementtree
 def _escape_cdata(text):
@@ -84,6 +96,15 @@ syst_collateral.set(
     "xsi:schemaLocation",
     "http://www.mipi.org/1.0/sys-t https://www.mipi.org/schema/sys-t/sys-t_1-0.xsd",
 )
+# delta timestamps are an extension that sys-t 1.0 collateral cannot express
+syst_collateral.append(
+    et.Comment(
+        " Timestamped records (header bit 11) with header bit 7 set carry a"
+        " 32-bit delta timestamp field instead of the 64-bit one. Their time is"
+        " the 64-bit value with those low 32 bits that is nearest to the most"
+        " recent full timestamp. "
+    )
+)
 syst_client = et.SubElement(syst_collateral, "syst:Client")
 syst_client.set("Name", client_name)
 syst_fwversion = et.SubElement(syst_collateral, "syst:FwVersion")
@@ -113,6 +134,55 @@ def find_arg_split_pos(s, start):
     return len(s)
 
 
+def decode_chars(s):
+    chars = re.split(r"\s*,\s*", s.replace("(char)", ""))
+    return "".join([chr(int(c)) for c in chars])
+
+
+# arguments are cataloged as fixed-width types; anything else is sent as a
+# 32-bit value. On the wire (sys-t id32_p32), each argument takes its C-promoted
+# width, as printf's variadic arguments do: 8 bytes for 64-bit values and 4
+# bytes for anything else, sign-extended if signed. The printf conversions keep
+# the cataloged width (e.g. %hhu) so that decoders print the value as that type.
+type_sizes = {
+    "bool": 1,
+    "signed char": 1,
+    "unsigned char": 1,
+    "short": 2,
+    "unsigned short": 2,
+    "int": 4,
+    "unsigned int": 4,
+    "long long": 8,
+    "unsigned long long": 8,
+}
+
+printf_lengths = {1: "hh", 2: "h", 4: "", 8: "ll"}
+
+
+def type_size(arg):
+    return type_sizes.get(arg, 4)
+
+
+def arg_size(arg):
+    return max(type_size(arg), 4)
+
+
+def printf_conversion(spec, arg):
+    if spec == "":
+        unsigned = arg.startswith("unsigned") or arg == "bool"
+        spec = "u" if unsigned else "d"
+    return "%" + spec[:-1] + printf_lengths[type_size(arg)] + spec[-1]
+
+
+def to_printf(s, args):
+    arg_iter = iter(args)
+    return re.sub(
+        r"{:?(.*?)}",
+        lambda m: printf_conversion(m.group(1), next(arg_iter, "int")),
+        s,
+    )
+
+
 def split_args(s):
     args = []
     start = 0
@@ -123,67 +193,194 @@ def split_args(s):
     return args
 
 
-with open(input_file, "r") as f:
-    for line in f:
-        catalog_m = catalog_re.match(line)
+def message_key(level, msg, arg_types):
+    return (level, msg, tuple(arg_types))
+
 
-        if catalog_m:
-            string_m = string_re.match(catalog_m.group(2))
-            catalog_type = catalog_m.group(1)
-            log_level = string_m.group(1)
-            arg_tuple = string_m.group(2)
-            string_tuple = string_m.group(3).replace("(char)", "")
-            string_value = "".join(
-                [chr(int(c)) for c in re.split(r"\s*,\s*", string_tuple)]
+def hash_id(key):
+    digest = hashlib.sha256(repr(key).encode("utf-8")).digest()
+    return int.from_bytes(digest[:4], "little") & max_string_id
+
+
+class IdAllocator:
+    """Hands out IDs that are not yet in use, sequentially or from a hash.
+
+    IDs stay within max_string_id: a sequential ID that would exceed it wraps
+    around to the lowest free ID, which matters after IDs have been hashed.
+    """
+
+    def __init__(self, used, use_hash):
+        self.used = set(used)
+        self.use_hash = use_hash
+        self.next_id = (max(self.used, default=-1) + 1) & max_string_id
+
+    def allocate(self, key):
+        if len(self.used) > max_string_id:
+            raise SystemExit(
+                "gen_str_catalog: all 0x%X IDs are in use" % (max_string_id + 1)
             )
+        new_id = hash_id(key) if self.use_hash else self.next_id
+        while new_id in self.used:
+            new_id = (new_id + 1) & max_string_id
+        self.next_id = (new_id + 1) & max_string_id
+        self.used.add(new_id)
+        return new_id
 
-            if catalog_type not in cataloged_strings:
-                cataloged_strings.add(catalog_type)
-                out.write("/*\n")
-                out.write('    "' + string_value + '"\n')
-                out.write("\n")
-                out.write("   " + arg_tuple + "\n")
-                out.write(" */\n")
-                out.write(
-                    "template<> {} {{\n    return {};\n}}\n".format(
-                        catalog_type, string_id
+
+strings = []
+cataloged_strings = set()
+
+module_types = []
+cataloged_modules = set()
+
+# symbols found in several inputs are cataloged once
+for input_file in input_files:
+    with open(input_file, "r") as f:
+        for line in f:
+            catalog_m = catalog_re.match(line)
+
+            if catalog_m:
+                catalog_type = catalog_m.group(1)
+                if catalog_type not in cataloged_strings:
+                    cataloged_strings.add(catalog_type)
+                    string_m = string_re.match(catalog_m.group(2))
+                    arg_tuple = string_m.group(2)
+                    strings.append(
+                        dict(
+                            catalog_type=catalog_type,
+                            level=levels[int(string_m.group(1))],
+                            arg_tuple=arg_tuple,
+                            args=split_args(arg_tuple),
+                            msg=decode_chars(string_m.group(3)),
+                        )
                     )
-                )
-                out.write("\n")
-
-                args = split_args(arg_tuple)
-
-                msg_type = "msg"
-                if string_value.startswith("flow."):
-                    msg_type = "flow"
-
-                messages.append(
-                    dict(
-                        level=levels[int(log_level)],
-                        msg=string_value,
-                        type=msg_type,
-                        id=string_id,
-                        arg_types=args,
-                        arg_count=len(args),
+
+            module_m = module_re.match(line)
+
+            if module_m:
+                module_type = module_m.group(1)
+                if module_type not in cataloged_modules:
+                    cataloged_modules.add(module_type)
+                    module_name = decode_chars(
+                        module_string_re.match(module_m.group(2)).group(1)
                     )
-                )
-
-                if len(args) == 0:
-                    syst_format = et.SubElement(syst_short_message, "syst:Format")
-                    syst_format.set("ID", "0x%08X" % string_id)
-                    syst_format.set("Mask", "0x0FFFFFFF")
-                    printf_string = string_value
-                else:
-                    syst_format = et.SubElement(syst_catalog_message, "syst:Format")
-                    syst_format.set("ID", "0x%08X" % string_id)
-                    syst_format.set("Mask", "0xFFFFFFFF")
-                    printf_string = re.sub(r"{}", r"%d", string_value)
-                    printf_string = re.sub(r"{:(.*?)}", r"%\1", printf_string)
-                syst_format.text = "<![CDATA[" + printf_string + "]]>"
-
-                string_id += 1
-
-str_catalog = dict(messages=messages)
+                    module_types.append((module_type, module_name))
+
+# strings and modules keep the IDs they had in a previous build; strings that
+# are gone are kept too, so that their IDs are not reused and old traces can
+# still be decoded
+known_messages = {}
+known_modules = {}
+if cli_args.known_ids:
+    with open(cli_args.known_ids, "r") as kf:
+        known_catalog = json.load(kf)
+    for m in known_catalog.get("messages", []):
+        known_messages[message_key(m["level"], m["msg"], m["arg_types"])] = m
+    for m in known_catalog.get("modules", []):
+        known_modules[m["name"]] = m["id"]
+
+string_ids = IdAllocator(
+    [m["id"] for m in known_messages.values()], cli_args.hash_ids
+)
+# module IDs index catalog_module_levels, so they stay dense
+module_ids = IdAllocator(known_modules.values(), False)
+
+messages = []
+
+out = open(cpp_file, "w")
+
+out.write(
+    """
+#include <log/catalog/catalog.hpp>
+
+"""
+)
+
+for s in strings:
+    key = message_key(s["level"], s["msg"], s["args"])
+    if key in known_messages:
+        string_id = known_messages.pop(key)["id"]
+    else:
+        string_id = string_ids.allocate(key)
+
+    out.write("/*\n")
+    out.write('    "' + s["msg"] + '"\n')
+    out.write("\n")
+    out.write("   " + s["arg_tuple"] + "\n")
+    out.write(" */\n")
+    out.write(
+        "template<> {} {{\n    return {};\n}}\n".format(s["catalog_type"], string_id)
+    )
+    out.write("\n")
+
+    args = s["args"]
+
+    msg_type = "msg"
+    if s["msg"].startswith("flow."):
+        msg_type = "flow"
+
+    messages.append(
+        dict(
+            level=s["level"],
+            msg=s["msg"],
+            type=msg_type,
+            id=string_id,
+            arg_types=args,
+            arg_count=len(args),
+            arg_sizes=[arg_size(a) for a in args],
+        )
+    )
+
+messages.extend(known_messages.values())
+
+for m in messages:
+    printf_string = "<![CDATA[" + to_printf(m["msg"], m["arg_types"]) + "]]>"
+    if m["arg_count"] == 0:
+        syst_format = et.SubElement(syst_short_message, "syst:Format")
+        syst_format.set("ID", "0x%08X" % m["id"])
+        syst_format.set("Mask", "0x0FFFFFFF")
+        syst_format.text = printf_string
+    # timestamped messages without arguments are sent as catalog messages too
+    syst_format = et.SubElement(syst_catalog_message, "syst:Format")
+    syst_format.set("ID", "0x%08X" % m["id"])
+    syst_format.set("Mask", "0xFFFFFFFF")
+    syst_format.text = printf_string
+
+modules = []
+
+for module_type, module_name in module_types:
+    if module_name in known_modules:
+        module_id = known_modules.pop(module_name)
+    else:
+        module_id = module_ids.allocate(module_name)
+    out.write("/*\n")
+    out.write("    module " + module_name + "\n")
+    out.write(" */\n")
+    out.write("template<> std::atomic<std::uint8_t> {}{{}};\n".format(module_type))
+    out.write("\n")
+    modules.append(dict(name=module_name, id=module_id, type=module_type))
+
+# modules that are gone keep their IDs, and share a level nobody reads
+module_levels = ["&absent_module_quietness"] * (
+    max([m["id"] for m in modules] + list(known_modules.values()), default=-1) + 1
+)
+for m in modules:
+    module_levels[m["id"]] = "&" + m.pop("type")
+
+out.write("namespace {\nstd::atomic<std::uint8_t> absent_module_quietness{};\n")
+out.write("std::atomic<std::uint8_t> *const module_levels[] = {\n")
+for level in module_levels:
+    out.write("    {},\n".format(level))
+# the trailing entry only keeps the array non-empty; it is not in the span
+out.write("    &absent_module_quietness};\n} // namespace\n\n")
+out.write("std::span<std::atomic<std::uint8_t> *const> const catalog_module_levels{\n")
+out.write("    module_levels, {}}};\n".format(len(module_levels)))
+
+modules.extend(dict(name=name, id=id) for name, id in known_modules.items())
+
+out.close()
+
+str_catalog = dict(messages=messages, modules=modules)
 
 # for bit_mask_file in bit_mask_files:
 #     bit_mask_def = json.load(open(bit_mask_file))